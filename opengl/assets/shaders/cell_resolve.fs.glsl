@@ -0,0 +1,32 @@
+#version 330 core
+out vec4 o;
+
+// Un fragmento por celda (viewport = rejilla, scissor = dirty rect): material ->
+// color lineal con tinte por celda y emisivo, para grid_cached.fs.glsl
+uniform usampler2D uTex;   // indices R8UI
+uniform vec2 uGrid;        // (w,h)
+uniform int uEffects = 1;  // 0: sin variacion de color
+layout(std140) uniform Palette { vec4 colors[256]; vec4 extra[256]; };
+
+// hash determinista por celda (el mismo que grid.fs.glsl)
+float hash2(ivec2 p){
+    uint x = uint(p.x)*374761393u ^ uint(p.y)*668265263u;
+    x = (x ^ (x>>13)) * 1274126177u;
+    x ^= x >> 16u;
+    return float(x & 1023u) / 1023.0; // [0,1]
+}
+
+void main(){
+  ivec2 t = ivec2(gl_FragCoord.xy);
+  uint m = texelFetch(uTex, t, 0).r;
+  vec4 c = colors[int(m)];
+  if (m == 0u || c.a <= 0.0) { o = vec4(0.0); return; }
+
+  vec3 base_lin = pow(c.rgb, vec3(2.2));
+  if (uEffects != 0) {
+    // grid.fs.glsl indexa el hash con y hacia arriba
+    float n = hash2(ivec2(t.x, int(uGrid.y) - 1 - t.y))*2.0 - 1.0;
+    base_lin = clamp(base_lin * (1.0 + 0.15*n), 0.0, 1.0);
+  }
+  o = vec4(base_lin * max(extra[int(m)].x, 0.0), c.a);
+}
@@ -5,6 +5,7 @@ out vec4 o;
 uniform usampler2D uTex;   // ndices R8UI
 uniform vec2 uGrid;        // (w,h)
 uniform vec2 uView;        // viewport px
+uniform int uEffects = 1;  // 0: celdas planas (sin discos ni variacion), mas barato
 layout(std140) uniform Palette { vec4 colors[256]; vec4 extra[256]; };
 
 // hash determinista por celda
@@ -33,6 +34,8 @@ void main(){
   if (c.a <= 0.0) discard;
 
   vec3 base_lin = pow(c.rgb, vec3(2.2));
+  float emis = max(extra[int(m)].x, 0.0);
+  if (uEffects == 0) { o = vec4(base_lin * emis, c.a); return; }
 
   // -------- variacion de color por celda --------
   ivec2 cellId = ivec2(clamp(floor(uv2 * uGrid), vec2(0), uGrid - 1.0));
@@ -46,8 +49,6 @@ void main(){
   float r = length(p);
 
 
-  float emis = max(extra[int(m)].x, 0.0);
-
    // --------- Parametros de los puntos ----------
   float radius  = 0.35;
   float feather = 0.30;
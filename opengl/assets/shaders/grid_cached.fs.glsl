@@ -0,0 +1,36 @@
+#version 330 core
+in vec2 uv;
+out vec4 o;
+
+// Como grid.fs.glsl, pero el color de cada celda ya viene resuelto en uCells
+// (cell_resolve.fs.glsl): aqui solo queda el escalado y la mascara del disco
+uniform sampler2D uCells;  // RGBA16F lineal, a resolucion de rejilla
+uniform vec2 uGrid;        // (w,h)
+uniform vec2 uView;        // viewport px
+uniform int uEffects = 1;  // 0: celdas planas, sin disco
+
+void main(){
+  vec2 scale = floor(uView / uGrid);
+  float s = max(1.0, min(scale.x, scale.y));
+  vec2 size = uGrid * s;
+  vec2 off  = (uView - size) * 0.5;
+
+  vec2 frag = gl_FragCoord.xy - off;
+  if (any(lessThan(frag, vec2(0))) || any(greaterThanEqual(frag, size)))
+    discard;
+
+  vec2 uv2 = frag / size;
+  ivec2 t = ivec2(clamp(floor(vec2(uv2.x, 1.0 - uv2.y) * uGrid), vec2(0), uGrid - 1.0));
+  vec4 c = texelFetch(uCells, t, 0);
+  if (c.a <= 0.0) discard;
+  if (uEffects == 0) { o = c; return; }
+
+  // --------- Parametros de los puntos ----------
+  float radius  = 0.35;
+  float feather = 0.30;
+  // ----------------------------------------------
+  float r = length(fract(uv2 * uGrid) - vec2(0.5));
+  float alpha = 1.0 - smoothstep(radius, radius + feather, r);
+  o = vec4(c.rgb, c.a * alpha);
+  if (o.a <= 0.001) discard;
+}
@@ -0,0 +1,63 @@
+#version 330 core
+in vec2 uv;
+out vec4 o;
+
+// Como grid.fs.glsl, pero los indices vienen en un array de teselas de uTileSize^2
+// (capa = ty * uTilesX + tx) para rejillas mas grandes que GL_MAX_TEXTURE_SIZE
+uniform usampler2DArray uTiles;  // indices R8UI
+uniform int uTileSize;
+uniform int uTilesX;
+uniform vec2 uGrid;        // (w,h)
+uniform vec2 uView;        // viewport px
+uniform int uEffects = 1;  // 0: celdas planas (sin discos ni variacion), mas barato
+layout(std140) uniform Palette { vec4 colors[256]; vec4 extra[256]; };
+
+// hash determinista por celda
+float hash2(ivec2 p){
+    uint x = uint(p.x)*374761393u ^ uint(p.y)*668265263u;
+    x = (x ^ (x>>13)) * 1274126177u;
+    x ^= x >> 16u;
+    return float(x & 1023u) / 1023.0; // [0,1]
+}
+
+void main(){
+  vec2 scale = floor(uView / uGrid);
+  float s = max(1.0, min(scale.x, scale.y));
+  vec2 size = uGrid * s;
+  vec2 off  = (uView - size) * 0.5;
+
+  vec2 frag = gl_FragCoord.xy - off;
+  if (any(lessThan(frag, vec2(0))) || any(greaterThanEqual(frag, size)))
+    discard;
+
+  vec2 uv2 = frag / size;
+  ivec2 texel = ivec2(clamp(floor(vec2(uv2.x, 1.0 - uv2.y) * uGrid), vec2(0), uGrid - 1.0));
+  ivec2 tile = texel / uTileSize;
+  uint m = texelFetch(uTiles, ivec3(texel - tile * uTileSize, tile.y * uTilesX + tile.x), 0).r;
+  if (m==0u) discard;
+
+  vec4 c = colors[int(m)];
+  if (c.a <= 0.0) discard;
+
+  vec3 base_lin = pow(c.rgb, vec3(2.2));
+  float emis = max(extra[int(m)].x, 0.0);
+  if (uEffects == 0) { o = vec4(base_lin * emis, c.a); return; }
+
+  // -------- variacion de color por celda --------
+  ivec2 cellId = ivec2(clamp(floor(uv2 * uGrid), vec2(0), uGrid - 1.0));
+  float n = hash2(cellId)*2.0 - 1.0;  // [-1,1]
+  float k = 0.15;                     // intensidad
+  base_lin = clamp(base_lin * (1.0 + k*n), 0.0, 1.0);
+  // ----------------------------------------------
+
+  float r = length(fract(uv2 * uGrid) - vec2(0.5));
+
+  // --------- Parametros de los puntos ----------
+  float radius  = 0.35;
+  float feather = 0.30;
+  // ----------------------------------------------
+
+  float alpha = 1.0 - smoothstep(radius, radius + feather, r);
+  o = vec4(base_lin * emis, c.a * alpha);
+  if (o.a <= 0.001) discard;
+}
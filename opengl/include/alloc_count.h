@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+// Contador de reservas (operator new/new[]) para comprobar que el bucle de frames no
+// reserva memoria en regimen estable. Solo se instala con -DFALLINGSAND_ALLOC_COUNT=ON
+// (define FS_ALLOC_COUNT); sin el, allocCountEnabled() es false y los contadores 0.
+// Cuenta lo que pasa por operator new: malloc directo de C (GLFW, driver) no entra.
+bool allocCountEnabled();
+std::uint64_t allocCount();     // reservas desde el arranque, todos los hilos
+std::uint64_t allocBytes();
@@ -3,10 +3,9 @@
 #include <unordered_map>
 #include <vector>
 #include "./../third_party/miniaudio/miniaudio.h"
+#include "engine.h"
 
 
-struct Engine;
-
 class Audio {
 public:
     bool init();
@@ -33,5 +32,8 @@ private:
     };
     std::unordered_map<std::string, Sfx> sfx;
 
+    // Se intercambia con la cola del motor cada frame: las dos conservan su capacidad
+    std::vector<AudioEvent> events;
+
     static float clamp01(float v) { return v < 0.f ? 0.f : (v > 1.f ? 1.f : v); }
 };
@@ -0,0 +1,84 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "engine.h"
+
+// Estadisticas por mundo, acumuladas entre llamadas a step()
+struct WorldStats {
+    std::uint64_t ticks = 0;
+    std::uint64_t dirtyCells = 0;   // area sumada de los dirty-rects de cada tick
+    std::uint64_t quietTicks = 0;   // ticks sin ningun cambio
+    double seconds = 0.0;           // tiempo de simulacion dedicado a este mundo
+    std::array<std::uint32_t, 256> counts{}; // celdas por material tras el ultimo step()
+    std::uint64_t hash = 0;         // stateHash() tras el ultimo tick
+};
+
+// N mundos independientes (sin ventana ni GL) avanzados en un pool de hilos.
+// Cada mundo se trocea en rodajas de ticks; un mundo solo vive en una cola a la vez,
+// asi que nunca lo tocan dos hilos. Los hilos sin trabajo roban de las colas ajenas y,
+// si no hay nada que robar, duermen hasta que sobre trabajo o acabe el step().
+class BatchRunner {
+public:
+    BatchRunner(int worlds, int gridW, int gridH, int threads = 0, std::uint32_t baseSeed = 1,
+        SimMode mode = SimMode::Scan, GridLayout layout = GridLayout::Linear);
+    ~BatchRunner();
+
+    int size() const { return (int)worlds.size(); }
+    // Semilla del mundo i (para reproducirlo fuera del batch)
+    static std::uint32_t worldSeed(std::uint32_t baseSeed, int i);
+    int threadCount() const { return (int)pool.size(); }
+
+    // Acceso para preparar la escena inicial (no llamar durante step())
+    Engine& world(int i) { return *worlds[i]; }
+    const Engine& world(int i) const { return *worlds[i]; }
+
+    // Avanza todos los mundos 'ticks' ticks; bloquea hasta que terminan
+    void step(int ticks);
+
+    const WorldStats& stats(int i) const { return worldStats[i]; }
+    void snapshot(int i, std::vector<std::uint8_t>& out) const;
+
+    int sliceTicks = 8; // granularidad del robo de trabajo
+
+private:
+    struct Queue {
+        std::mutex mtx;
+        std::deque<int> items;
+    };
+
+    std::vector<std::unique_ptr<Engine>> worlds;
+    std::vector<WorldStats> worldStats;
+    std::vector<int> remaining;     // ticks pendientes por mundo en el step() actual
+
+    std::vector<std::thread> pool;
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    std::mutex mtx;
+    std::condition_variable wake, done;
+    std::uint64_t generation = 0;
+    int busyWorkers = 0;
+    bool quit = false;
+    std::atomic<int> pendingWorlds{ 0 };
+
+    // Hilos sin nada que robar: esperan a que una cola tenga trabajo de sobra (mas de
+    // un mundo) o a que pendingWorlds llegue a 0
+    std::mutex idleMtx;
+    std::condition_variable idle;
+    std::atomic<int> queued{ 0 };   // mundos en las colas (se cambia con el mutex de la cola)
+    int sleepers = 0;               // con idleMtx
+
+    void workerLoop(int id);
+    bool popOrSteal(int id, int& world);
+    void wakeIdle(bool all);
+    void runSlice(int worldIdx);
+
+    BatchRunner(const BatchRunner&) = delete;
+    BatchRunner& operator=(const BatchRunner&) = delete;
+};
@@ -1,7 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <cstdint>
 #include "material.h"
+#include "world_hash.h"
+#include "material_summary.h"
+#include "occupancy.h"
+#include "lod.h"
 
 
 
@@ -12,65 +18,293 @@ struct AudioEvent {
 };
 
 
+// Scan: barrido fila a fila con doble buffer y kernels por material (por defecto).
+// Margolus: automata de bloques 2x2 con la rejilla desplazada un paso cada tick; cada
+// bloque se resuelve solo con sus 4 celdas (blockRule), sin velocidades ni orden de barrido.
+enum class SimMode : std::uint8_t { Scan, Margolus };
+
+// Orden de las Cell (front/back) en memoria. El plano de materiales (planeM), la
+// ocupacion y el hash siguen fila a fila: son la copia ya destileada que leen el
+// renderer, el hash y las herramientas, asi que el layout no sale del motor.
+//   Linear: y*w + x
+//   Tiled:  teselas de 8x8 fila a fila; dentro, fila a fila (y+1 queda a 8 celdas)
+//   Morton: teselas de 8x8 fila a fila; dentro, orden Z
+enum class GridLayout : std::uint8_t { Linear, Tiled, Morton };
+
+// Fases de tick() que se pueden medir por separado (bench --perf). Sync: back = front
+// en las filas marcadas; Step: los kernels (en Margolus todo el tick es Step)
+enum class TickPhase : std::uint8_t { Sync, Step };
+struct TickProbe {
+    virtual ~TickProbe() = default;
+    virtual void begin(TickPhase p) = 0;
+    virtual void end(TickPhase p) = 0;
+};
+
+// Despues de cada tick() que corre update(): lo que tenga que ver todos los ticks
+// (grabacion) y no solo el estado al final del frame
+struct TickObserver {
+    virtual ~TickObserver() = default;
+    virtual void ticked(const Engine& e) = 0;
+};
+
 class Engine {
 public:
-    Engine(int gridW, int gridH);
+    Engine(int gridW, int gridH, std::uint32_t seed = 0x9E3779B9u, SimMode mode = SimMode::Scan,
+        GridLayout layout = GridLayout::Linear);
+
+    SimMode mode() const { return simMode; }
+    GridLayout layout() const { return cellLayout; }
 
     void update(float dt);
+    void tick();    // un paso fijo, sin acumulador (headless / batch)
+    std::uint64_t ticks() const { return tickCount; }
     void paint(int cx, int cy, Material m, int radius);
+    // Sustituye el plano entero (w*h ids); las velocidades se reinician
+    void setPlane(const std::uint8_t* src);
+
+    // Ediciones en bloque. Como paint(), escriben el buffer visible con efecto
+    // inmediato; van por spans de fila (memset/memcpy) y marcan dirty una vez por span.
+    // Todo se recorta a la rejilla.
+    void fillRect(int x, int y, int rw, int rh, Material m);
+    void fillCircle(int cx, int cy, int r, Material m);
+    // Poligono simple o no (regla par-impar); xy = {x0,y0, x1,y1, ...}, n vertices
+    void fillPolygon(const int* xy, int n, Material m);
+    // Pega sw*sh ids en (x,y); las celdas con valor 'transparent' no se tocan
+    void stamp(int x, int y, int sw, int sh, const std::uint8_t* src,
+        std::uint8_t transparent = (std::uint8_t)Material::NullCell);
+    // Copia el rect a 'out' (rw*rh, NullCell fuera de la rejilla) para pegarlo con stamp()
+    void copyRegion(int x, int y, int rw, int rh, std::vector<std::uint8_t>& out) const;
+    // Copia un rect de otro mundo (o de este mismo, aunque se solape) a (dx,dy)
+    void copyFrom(const Engine& src, int sx, int sy, int rw, int rh, int dx, int dy);
 
     int width()  const { return w; }
     int height() const { return h; }
 
     const std::uint8_t* planeM() const { return mFront.data(); }
 
+    // Hash Zobrist de planeM(), mantenido en O(1) por escritura (ver world_hash.h)
+    std::uint64_t stateHash() const { return hashFront; }
+    // Sub-hashes por chunk para localizar una divergencia; desactivados por defecto
+    void enableChunkHashes(bool on);
+    bool chunkHashesEnabled() const { return chunkHashing; }
+    int hashChunksX() const { return hcw; }
+    int hashChunksY() const { return hch; }
+    std::uint64_t chunkHash(int cx, int cy) const { return chunkHashing ? chunkFront[size_t(cy * hcw + cx)] : 0; }
+
+    // Resumen por chunk (conteos + mascara de materiales) para SpatialQuery; opcional.
+    // Refleja el ultimo plano escrito: consultar entre ticks, no desde los kernels.
+    void enableSummary(bool on);
+    const MaterialSummary* summary() const { return summaryOn ? &matSummary : nullptr; }
+
+    // Celdas emisivas (MatProps::emissive > 1, las unicas que pasan el umbral del bloom)
+    // contadas por tesela de 32x32, para que el renderer recorte el bloom a donde hay
+    // algo que brille. Como el resumen: opcional y consultado entre ticks.
+    void trackEmissive(bool on);
+    bool emissiveTracked() const { return emissiveOn; }
+    int emissiveCells() const { return emissiveTotal; }
+    // Hasta maxRects rects {x, y, w, h} en celdas (teselas enteras, recortadas a la
+    // rejilla) que cubren todas las teselas con emisivos; si no caben, su envolvente.
+    // Devuelve cuantos escribio: 0 = no hay nada emisivo (o seguimiento apagado)
+    int emissiveRects(int* xywh, int maxRects) const;
+
     // Dirty-rect: true si hay cambios (rellena x,y,rw,rh)
     bool takeDirtyRect(int& x, int& y, int& rw, int& rh);
+    // Igual, pero sin consumirlo (grabacion, publicacion); llamar antes del take del frame
+    bool peekDirtyRect(int& x, int& y, int& rw, int& rh) const;
 
+    // Intercambia la cola con 'out' (que debe llegar vacia): reutilizando el mismo
+    // vector cada frame ninguno de los dos vuelve a reservar
     bool takeAudioEvents(std::vector<AudioEvent>& out) {
         if (audioEvents.empty()) return false;
         out.swap(audioEvents);
+        audioEvents.clear();
         return true;
     }
 
     // util
-    int idx(int x, int y) const { return y * w + x; }
+    int idx(int x, int y) const { return y * w + x; }              // plano (fila a fila)
+    // Posicion de (x,y) en front/back segun el layout; separable en fila + columna.
+    // Valido en [-1, w] x [-1, h]: las Cell llevan un anillo de NullCell alrededor
+    int cellIdx(int x, int y) const {
+        return runMask < 0 ? y * stride + x + ringBase : rowOff[size_t(y + 1)] + colOff[size_t(x + 1)];
+    }
     static bool inRange(int x, int y, int W, int H) { return x >= 0 && x < W && y >= 0 && y < H; }
     bool inRange(int x, int y) { return x >= 0 && x < w && y >= 0 && y < h; }
     Cell read(int x, int y) {
-        return (inRange(x, y)) ? front[idx(x, y)] : Cell{ (u8)Material::NullCell };
+        return (inRange(x, y)) ? front[cellIdx(x, y)] : Cell{ (u8)Material::NullCell };
+    }
+
+    // Recorre [x0, x1) de la fila y en tramos contiguos en memoria: f(i, x, n) con i el
+    // indice de la Cell de x y n celdas seguidas (toda la fila en Linear, hasta fin de
+    // tesela en Tiled, pares en Morton)
+    template <class F> void forEachRun(int y, int x0, int x1, F&& f) const {
+        for (int x = x0; x < x1;) {
+            const int n = runMask < 0 ? x1 - x : std::min(x1, (x + 1) | runMask) - x;
+            f(cellIdx(x, y), x, n);
+            x += n;
+        }
     }
 
     static bool randbit(int x, int y, int parity);
 
+    // Accesos de vecindad sin comprobar rango, para los kernels: (x,y) puede caer en el
+    // anillo [-1, w] x [-1, h], que es NullCell en los dos buffers y nunca se escribe,
+    // asi que el borde se comporta igual que read() (NullCell fuera de la rejilla)
+    u8 nbM(int x, int y) const { return front[cellIdx(x, y)].m; }
+    u8 nbNext(int x, int y) const { return back[cellIdx(x, y)].m; }
+    // Celda libre en back por el bitboard 'full' (el unico lector), sin cargar la Cell;
+    // el anillo (fuera de la rejilla, un compare sin signo por eje) nunca esta libre
+    bool nbVacant(int x, int y) const {
+        return unsigned(x) < unsigned(w) && unsigned(y) < unsigned(h) && !occBack.occupied(x, y);
+    }
+
+    // Ray-march: cuantas celdas libres consecutivas hay en (dx,dy), hasta maxSteps.
+    // Desde una celda de la rejilla; el anillo la corta sin comprobar rango
+    int castRay(int sx, int sy, int dx, int dy, int maxSteps) const;
+
+    // Kernels: el destino debe quedar en la rejilla o en el anillo (pasos de 1, o
+    // distancias sacadas de castRay); el anillo nunca se acepta
     bool tryMove(int sx, int sy, int dx, int dy, const Cell& c);
     bool trySwap(int sx, int sy, int dx, int dy, const Cell& c);
 
     void setCell(int x, int y, u8 m);
+    void setVelocity(int x, int y, int vx, int vy);
+
+    // Chunks tocados (para History): cualquier escritura de celda, velocidad incluida,
+    // marca su chunk de touchChunk x touchChunk. Desactivado por defecto.
+    static constexpr int touchShift = 5;
+    static constexpr int touchChunk = 1 << touchShift;
+    void trackTouched(bool on);
+    const std::vector<std::uint32_t>& touchedChunks() const { return touchedList; }
+    void clearTouched();
+    int touchChunksX() const { return (w + touchChunk - 1) >> touchShift; }
+    int touchChunksY() const { return (h + touchChunk - 1) >> touchShift; }
+
+    // Celdas de un chunk de touchChunk^2 (fila a fila; fuera de la rejilla se ignoran)
+    void readChunk(int cx, int cy, Cell* out) const;
+    void writeChunk(int cx, int cy, const Cell* in);   // en front, con dirty/hash/resumen
+
+    // LOD temporal (solo Scan): los chunks fuera de la vista o sin actividad reciente se
+    // actualizan 1 de cada N ticks (ver lod.h). Desactivado por defecto; con el activo
+    // el resultado ya no coincide tick a tick con el barrido completo.
+    void enableLod(bool on);
+    bool lodEnabled() const { return lodOn; }
+    LodScheduler* lod() { return lodOn ? &lodSched : nullptr; }
+    // Ticks que representa la actualizacion en curso (periodo del chunk); 1 sin LOD
+    int tickScale() const { return curScale; }
+
+    // Estado no espacial de la simulacion, para rebobinar exactamente
+    struct SimState { std::uint64_t ticks; int parity; std::uint32_t rng; };
+    SimState simState() const { return { tickCount, parity, rng }; }
+    void setSimState(const SimState& s) { tickCount = s.ticks; parity = s.parity; rng = s.rng; }
+
+    // RNG por mundo (xorshift32): reproducible y sin estado global
+    std::uint32_t rand32() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; }
+
+    // Velocidad en punto fijo: velOne = 1 celda/tick
+    static constexpr int velOne = 16;
+    int gravity = 4;                // velOne / tick^2
+    int maxFallSpeed = 8 * velOne;  // tope de celdas por tick
 
     bool stepOnce = false;
     bool paused = false;
+    // Ticks maximos por update(); el atraso que sobre se descarta en vez de encadenar
+    // frames cada vez mas lentos. 0 = sin limite
+    int maxStepsPerUpdate = 0;
+    bool audioEnabled = true;   // sin consumidor (batch) los eventos solo crecerian
+    TickProbe* probe = nullptr; // alrededor de cada fase de tick(); null = sin coste
+    TickObserver* observer = nullptr;   // tras cada tick de update()
 
 private:
 
     int w, h;
+    SimMode simMode;
+    GridLayout cellLayout;
     std::vector<Cell> front, back;
+    std::vector<int> rowOff, colOff;    // cellIdx = rowOff[y+1] + colOff[x+1] (con anillo)
+    int stride = 0, ringBase = 0;       // Linear: (w+2) por fila, (0,0) en stride+1
+    int runMask = -1;                   // tramo contiguo maximo - 1; -1 = fila entera
+    void buildLayout();
     std::vector<u8> mFront, mBack;
 
+    // Hash del plano: toda escritura en mFront/mBack pasa por writeFront/writeBack
+    std::uint64_t hashFront = 0, hashBack = 0;
+    bool chunkHashing = false;
+    int hcw = 0, hch = 0;
+    std::vector<std::uint64_t> chunkFront, chunkBack;
+    // Un solo resumen basta: durante step() solo se escribe back, fuera solo front,
+    // y al terminar el tick back pasa a ser front
+    bool summaryOn = false;
+    MaterialSummary matSummary;
+    bool emissiveOn = false;
+    std::array<bool, 256> emissiveMat{};
+    std::vector<std::uint16_t> emissiveCount;   // por tesela de kSummaryChunk^2
+    int emissiveTotal = 0;
+    void noteEmissive(int x, int y, u8 prev, u8 m) {
+        if (emissiveMat[prev] == emissiveMat[m]) return;
+        const int d = emissiveMat[m] ? 1 : -1;
+        emissiveCount[size_t((y >> kSummaryShift) * ((w + kSummaryChunk - 1) >> kSummaryShift) + (x >> kSummaryShift))] += std::uint16_t(d);
+        emissiveTotal += d;
+    }
+    void resetEmissive();
+    // Ocupacion por filas de cada buffer; step() solo visita los bits 'active' de front
+    Occupancy occFront, occBack;
+    void resetOccupancy();
+
+    bool touchOn = false;
+    std::vector<std::uint8_t> touchedFlag;
+    std::vector<std::uint32_t> touchedList;
+    void touch(int x, int y) {
+        const std::uint32_t c = std::uint32_t((y >> touchShift) * touchChunksX() + (x >> touchShift));
+        if (!touchedFlag[c]) { touchedFlag[c] = 1; touchedList.push_back(c); }
+    }
+    void touchRect(int x0, int y0, int x1, int y1);
+
+    bool lodOn = false;
+    LodScheduler lodSched;
+    int curScale = 1;
+    void writeBack(int x, int y, u8 m);
+    void writeFront(int x, int y, u8 m);
+    void noteFront(int x, int y, int i, u8 prev, u8 m);   // hash + resumen, sin escribir
+    void noteSpan(int y, int x0, int x1, const u8* src, u8 m);
+    void fillSpan(int y, int x0, int x1, u8 m);           // [x0, x1) en front, ya recortado
+    void copySpan(int y, int x0, int x1, const u8* src);
+    void rehash();
+
     // Timestep fijo
     float accumulator = 0.f;
     static constexpr float fixedStep = 1.f / 120.f;
     int parity = 0;
+    std::uint64_t tickCount = 0;
+    std::uint32_t rng;
 
     // sim
     void step();
-    void swapBuffers() { front.swap(back); mFront.swap(mBack); }
+    void stepMargolus();    // en front, sin copia a back
+    void swapBuffers() {
+        front.swap(back); mFront.swap(mBack); std::swap(occFront, occBack);
+        hashFront = hashBack; chunkFront.swap(chunkBack);
+    }
 
     // Dirty tracking
     int dirtyMinX, dirtyMinY, dirtyMaxX, dirtyMaxY;
+    // Celdas en que back y front pueden diferir, por fila [syncLo, syncHi]: tick() solo
+    // copia eso a back en lugar del mundo entero. Se marca con cualquier escritura.
+    std::vector<int> syncLo, syncHi;
+    void markSync(int y, int x0, int x1) {
+        if (x0 < syncLo[size_t(y)]) syncLo[size_t(y)] = x0;
+        if (x1 > syncHi[size_t(y)]) syncHi[size_t(y)] = x1;
+    }
+    void syncBack();
     void clearDirty(); 
     void markDirty(int x, int y);
     void markDirtyRect(int x0, int y0, int x1, int y1);
 
+    // Cola acotada: lo que pase de kMaxAudioEvents entre dos takeAudioEvents() se pierde
+    // (no hay voces para tanto) y el vector no vuelve a crecer
+    static constexpr size_t kMaxAudioEvents = 256;
     std::vector<AudioEvent> audioEvents;
+    void pushAudio(AudioEvent::Type t, int x, int y) {
+        if (audioEvents.size() < kMaxAudioEvents) audioEvents.push_back({ t, x, y });
+    }
 };
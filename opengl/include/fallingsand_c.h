@@ -0,0 +1,83 @@
+#pragma once
+/*
+ * API C estable de libfallingsand, para embeber el motor (ctypes, cffi, otros lenguajes).
+ *
+ * - Todas las funciones son de un solo mundo; mundos distintos pueden usarse
+ *   desde hilos distintos, un mismo mundo no.
+ * - Los planos son w*h bytes (ids de material), fila a fila, y=0 arriba.
+ * - El plano de fs_plane() es una vista directa del motor: valida hasta el
+ *   siguiente fs_step/fs_paint/fs_set_plane/fs_destroy.
+ * - Con un mundo NULL las funciones no hacen nada y devuelven 0 (NULL en fs_plane).
+ * - Ninguna funcion lanza excepciones: sin memoria fs_create devuelve NULL, las que
+ *   devuelven int fallan con 0 (-1 en fs_material_id) y las void no hacen nada.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(FALLINGSAND_BUILD)
+#    define FS_API __declspec(dllexport)
+#  else
+#    define FS_API __declspec(dllimport)
+#  endif
+#else
+#  define FS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FS_API_VERSION 1
+
+typedef struct fs_world fs_world;
+
+typedef struct fs_stats {
+    uint64_t ticks;         /* ticks simulados desde la creacion */
+    uint64_t dirty_cells;   /* area sumada de los dirty-rects de cada tick */
+    uint64_t quiet_ticks;   /* ticks sin ningun cambio */
+    double seconds;         /* tiempo pasado dentro de fs_step */
+    uint32_t counts[256];   /* celdas por material en el plano actual */
+} fs_stats;
+
+FS_API int fs_api_version(void);
+
+/* Tabla global de materiales: cargar antes de crear mundos. 1 = ok */
+FS_API int fs_load_materials(const char* path);
+/* id del material por nombre, -1 si no existe */
+FS_API int fs_material_id(const char* name);
+
+FS_API fs_world* fs_create(int width, int height, uint32_t seed);
+FS_API void fs_destroy(fs_world* w);
+
+FS_API int fs_width(const fs_world* w);
+FS_API int fs_height(const fs_world* w);
+FS_API uint64_t fs_ticks(const fs_world* w);
+
+/* Avanza 'ticks' pasos fijos de una vez */
+FS_API void fs_step(fs_world* w, int ticks);
+
+FS_API const uint8_t* fs_plane(const fs_world* w);
+/* Copia el plano en 'out' (size >= w*h). 1 = ok */
+FS_API int fs_get_plane(const fs_world* w, uint8_t* out, size_t size);
+/* Sustituye el plano entero desde 'src' (size == w*h). 1 = ok; 0 si algun id no es
+ * un material de la tabla (o es 255, reservado para el borde) */
+FS_API int fs_set_plane(fs_world* w, const uint8_t* src, size_t size);
+
+/* Ignora ids fuera de la tabla de materiales y 255 (reservado para el borde) */
+FS_API void fs_paint(fs_world* w, int cx, int cy, int material, int radius);
+
+/* Union de lo cambiado desde la ultima llamada. 1 si hay cambios */
+FS_API int fs_take_dirty_rect(fs_world* w, int* x, int* y, int* rw, int* rh);
+
+FS_API void fs_get_stats(const fs_world* w, fs_stats* out);
+
+/* Hash Zobrist del plano, actualizado en cada escritura (O(1) de consultar) */
+FS_API uint64_t fs_hash(const fs_world* w);
+/* Sub-hashes por chunk de 32x32 para localizar divergencias; 0 si no estan activados */
+FS_API void fs_enable_chunk_hashes(fs_world* w, int on);
+FS_API uint64_t fs_chunk_hash(const fs_world* w, int cx, int cy);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include "renderer.h"
+
+// Presupuesto de tiempo por frame: mide cada frame contra el objetivo y baja la
+// calidad en un orden fijo (bloom -> efectos del grid -> ritmo de simulacion) cuando
+// no llega, y la recupera cuando sobra margen. Sin GL: el llamador aplica quality()
+// al renderer y simRate() al dt del motor.
+//
+// Con vsync el intervalo entre frames no baja del refresco, asi que sirve para ver
+// que no se llega pero no cuanto sobra: para subir se usa el tiempo de trabajo del
+// frame (todo menos la espera del swap).
+class FrameGovernor {
+public:
+    struct Level {
+        const char* name;
+        RenderQuality render;
+        float simRate;      // 1 = tiempo real; < 1 = camara lenta en vez de tirones
+    };
+    static constexpr int kLevels = 7;
+    static const Level& level(int i);
+
+    explicit FrameGovernor(double targetMs = 1000.0 / 60.0) : target(targetMs) {}
+
+    // frameMs: intervalo entre frames; workMs: tiempo de trabajo del frame.
+    // true si el nivel cambio en este frame
+    bool frame(double frameMs, double workMs);
+
+    int current() const { return lvl; }
+    const RenderQuality& quality() const { return level(lvl).render; }
+    float simRate() const { return level(lvl).simRate; }
+    double targetMs() const { return target; }
+    double averageMs() const { return avgFrame; }
+
+    bool enabled = true;
+    bool log = true;        // transiciones por stderr
+
+    // Histeresis: frames seguidos por encima/debajo antes de cambiar, y enfriamiento
+    int degradeAfter = 20;
+    int restoreAfter = 180;
+    int cooldown = 60;
+
+private:
+    double target;
+    double avgFrame = 0.0, avgWork = 0.0;
+    int lvl = 0;
+    int over = 0, under = 0, hold = 0;
+    std::uint64_t frames = 0;
+
+    void set(int to, const char* why);
+};
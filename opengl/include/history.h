@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "engine.h"
+
+// Checkpoints del mundo como chunks compartidos (copy-on-write).
+//
+// 'base' es el estado del checkpoint actual: un puntero compartido por chunk. Cada
+// checkpoint solo copia los chunks que el motor marco como tocados desde el anterior
+// y guarda el par (antes, despues) de cada uno; los demas siguen compartidos. Asi un
+// checkpoint cuesta O(chunks tocados) y deshacer/rehacer es reponer esos chunks.
+//
+// La pila se acota por memoria: al pasarse, se descartan los checkpoints mas viejos.
+class History {
+public:
+    explicit History(size_t budgetBytes = size_t(64) << 20) : budget(budgetBytes) {}
+
+    // Empieza a seguir 'e' (copia completa inicial) y vacia la pila
+    void attach(Engine& e);
+    void detach();
+    bool attached() const { return engine != nullptr; }
+
+    // Guarda el estado actual si cambio desde el ultimo checkpoint; descarta el redo
+    void checkpoint();
+
+    // Vuelve al checkpoint anterior. El primer undo guarda antes lo cambiado desde el
+    // ultimo checkpoint (para poder rehacerlo); dentro de una cadena de undo/redo lo que
+    // la simulacion haya avanzado desde el ultimo salto se descarta, asi que la
+    // simulacion puede seguir corriendo entre saltos. Solo checkpoint() (una edicion del
+    // usuario) corta la cadena y descarta el redo
+    bool undo();
+    // Avanza al siguiente checkpoint deshecho; false si no hay
+    bool redo();
+
+    bool canUndo() const { return cursor > 0 || (engine && !jumped && !engine->touchedChunks().empty()); }
+    bool canRedo() const { return cursor < steps.size(); }
+    size_t undoDepth() const { return cursor; }
+    size_t redoDepth() const { return steps.size() - cursor; }
+    size_t bytesUsed() const { return used; }
+
+private:
+    static constexpr int kCells = Engine::touchChunk * Engine::touchChunk;
+    struct Chunk { Cell cells[kCells]; };
+    using ChunkPtr = std::shared_ptr<const Chunk>;
+
+    struct Change {
+        std::uint32_t chunk;
+        ChunkPtr before, after;
+    };
+    // Estado del LOD (null sin LOD): se comparte entre pasos como los chunks
+    using LodPtr = std::shared_ptr<const LodScheduler::State>;
+
+    struct Step {
+        std::vector<Change> changes;
+        Engine::SimState before, after;
+        LodPtr lodBefore, lodAfter;
+        size_t bytes = 0;   // chunks nuevos de este paso
+    };
+
+    Engine* engine = nullptr;
+    size_t budget;
+    size_t used = 0;
+    std::vector<ChunkPtr> base;
+    Engine::SimState baseState{};
+    LodPtr baseLod;
+    bool jumped = false;        // el mundo viene de un undo/redo, no de una edicion
+    std::vector<Step> steps;    // [0, cursor) deshacibles, [cursor, size) rehacibles
+    size_t cursor = 0;
+
+    LodPtr snapshotLod() const;
+    void restore(const Engine::SimState& st, const LodPtr& lodState);
+    void discardTouched();
+    void apply(const Step& s, bool forward);
+    void trim();
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Nivel de detalle temporal por chunk de 32x32: cada chunk tiene un periodo (se
+// actualiza 1 de cada N ticks) segun si cae en la vista y si ha tenido escrituras
+// hace poco. step() solo visita las celdas activas de los chunks que tocan este tick,
+// y los kernels compensan con tickScale() (caida, dispersion y probabilidades xN).
+//
+// Fronteras: un chunk que no corre se comporta como celdas en reposo. Sus celdas
+// siguen en back tal cual (back empieza como copia de front) y cualquier movimiento
+// desde un chunk vecino pasa por tryMove/trySwap contra back, asi que no se duplica
+// ni se pierde material; solo se retrasa.
+class LodScheduler {
+public:
+    static constexpr int kShift = 5;
+    static constexpr int kChunk = 1 << kShift;
+
+    // Periodo por clase: {visible y activo, visible quieto, fuera y activo, fuera quieto}.
+    // Potencias de 2 hasta 64
+    int periods[4] = { 1, 2, 4, 8 };
+    int activeWindow = 60;      // ticks sin escrituras para pasar a "quieto"
+
+    void resize(int w, int h);
+    // Rect visible en celdas [x0, x1) x [y0, y1); por defecto el mundo entero
+    void setView(int x0, int y0, int x1, int y1);
+
+    // Escritura en la celda (x,y): el chunk vuelve a contar como activo
+    void note(int x, int y) { hit[std::size_t((y >> kShift) * cw + (x >> kShift))] = 1; }
+    void noteRect(int x0, int y0, int x1, int y1);
+
+    // Decide que chunks corren en el tick 'tick' y rellena las mascaras por fila
+    void plan(std::uint64_t tick);
+
+    // Mascara de celdas que corren este tick para la fila y (rowWords u64)
+    const std::uint64_t* runRow(int y) const { return mask.data() + std::size_t(y >> kShift) * std::size_t(words); }
+    int period(int x, int y) const { return per[std::size_t((y >> kShift) * cw + (x >> kShift))]; }
+    // Cuantas veces ha corrido el chunk de (x,y) hasta 'tick' con su periodo actual
+    std::uint64_t runIndex(int x, int y, std::uint64_t tick) const {
+        const std::size_t c = std::size_t((y >> kShift) * cw + (x >> kShift));
+        return (tick + c) / per[c];
+    }
+
+    int chunksX() const { return cw; }
+    int chunksY() const { return ch; }
+    int chunksRun() const { return ran; }   // del ultimo plan()
+
+    // Lo que plan() arrastra entre ticks (escrituras pendientes y ticks en reposo por
+    // chunk): con esto y el tick, un mundo rebobinado repite las mismas mascaras
+    struct State {
+        std::vector<std::uint8_t> hit;
+        std::vector<std::uint16_t> quiet;
+    };
+    void save(State& s) const { s.hit = hit; s.quiet = quiet; }
+    // Ignora un estado de otro tamano de rejilla
+    void restore(const State& s) {
+        if (s.hit.size() != hit.size()) return;
+        hit = s.hit; quiet = s.quiet;
+    }
+
+private:
+    int w = 0, h = 0, cw = 0, ch = 0, words = 0;
+    int vx0 = 0, vy0 = 0, vx1 = 0, vy1 = 0;     // vista en chunks, [vx0, vx1)
+    int ran = 0;
+    std::vector<std::uint8_t> hit, per;
+    std::vector<std::uint16_t> quiet;   // ticks desde la ultima escritura (satura)
+    std::vector<std::uint64_t> mask;    // una fila de u64 por fila de chunks
+};
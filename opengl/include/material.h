@@ -7,7 +7,17 @@ struct Engine;
 
 using u8 = std::uint8_t;
 
-enum class Material : u8 { NullCell = -1, Empty = 0, Sand, Water, Stone, Wood, Fire, Smoke };
+enum class Material : u8 { NullCell = 255, Empty = 0, Sand, Water, Stone, Wood, Fire, Smoke };
+
+// Clase de movimiento: decide que kernel generico actualiza el material
+enum class Movement : u8 { Static = 0, Powder, Liquid, Gas };
+
+// Cuando hay que visitar una celda del material (lo deduce compileMaterialTables):
+//   Static:   nunca (sin kernel: Empty, Stone)
+//   Reactive: estatico sin decaimiento cuyas unicas reglas son reacciones con vecinos
+//             (Wood): solo si tiene cerca un material que pueda hacerle reaccionar
+//   Active:   cada tick (o cada tickRate ticks en Scan)
+enum class UpdateClass : u8 { Static = 0, Reactive, Active };
 
 struct Cell {
     u8 m = (u8)Material::Empty;
@@ -21,9 +31,28 @@ struct MatProps {
     u8 r = 0, g = 0, b = 0, a = 255;
     u8 density = 1;
     float emissive = 1.0f; 
-
+    u8 dispersion = 0;      // liquidos: celdas laterales exploradas por update
+    Movement movement = Movement::Static;
+    // Se actualiza 1 de cada tickRate ticks (potencia de 2, <= 64). Solo en SimMode::Scan:
+    // un bloque Margolus mezcla materiales y se resuelve entero cada tick
+    u8 tickRate = 1;
+
+    UpdateClass updateClass = UpdateClass::Static;
+    bool wakesReactive = false;     // vecino de alguna regla de un material Reactive
     void (*update)(Engine&, int x, int y, const Cell& self) = nullptr;
 };
 
 const MatProps& matProps(u8 id);
 void registerDefaultMaterials();
+void ensureMaterials();   // registra los de serie si aun no hay tabla
+
+// Fichero de definicion (assets/materials/default.mat). false si no se pudo leer o
+// no define ningun material; en ese caso la tabla actual no se toca.
+bool loadMaterialFile(const char* path);
+u8 findMaterial(std::string_view name); // NullCell si no existe
+
+// Regla de bloque 2x2 para el modo Margolus: q = {arriba-izq, arriba-der, abajo-izq,
+// abajo-der}, NullCell fuera de la rejilla. Solo intercambia celdas o aplica las
+// reacciones/decaimientos de la tabla, asi que no depende de ningun otro bloque.
+// true si algo cambio.
+bool blockRule(Cell q[4], std::uint32_t rnd);
@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Resumen por chunk del plano de materiales: cuantas celdas de cada material hay y
+// una mascara de 256 bits de los presentes. Lo mantiene el motor desde sus puntos de
+// escritura (Engine::writeBack/writeFront); las consultas estan en spatial_query.h.
+
+static constexpr int kSummaryShift = 5;                 // chunks de 32x32
+static constexpr int kSummaryChunk = 1 << kSummaryShift;
+
+struct MaterialMask {
+    std::array<std::uint64_t, 4> bits{};
+
+    MaterialMask() = default;
+    explicit MaterialMask(std::uint8_t m) { set(m); }
+
+    void set(std::uint8_t m) { bits[m >> 6] |= std::uint64_t(1) << (m & 63); }
+    void clear(std::uint8_t m) { bits[m >> 6] &= ~(std::uint64_t(1) << (m & 63)); }
+    bool test(std::uint8_t m) const { return (bits[m >> 6] >> (m & 63)) & 1u; }
+    bool intersects(const MaterialMask& o) const {
+        return ((bits[0] & o.bits[0]) | (bits[1] & o.bits[1]) | (bits[2] & o.bits[2]) | (bits[3] & o.bits[3])) != 0;
+    }
+    bool empty() const { return (bits[0] | bits[1] | bits[2] | bits[3]) == 0; }
+};
+
+class MaterialSummary {
+public:
+    struct Chunk {
+        std::array<std::uint16_t, 256> counts{};
+        MaterialMask present;
+        std::uint32_t version = 0;  // cambia con cada escritura (invalida caches derivadas)
+    };
+
+    void reset(const std::uint8_t* plane, int w, int h) {
+        cw = (w + kSummaryChunk - 1) >> kSummaryShift;
+        ch = (h + kSummaryChunk - 1) >> kSummaryShift;
+        std::vector<std::uint32_t> versions(chunks.size());
+        for (std::size_t i = 0; i < chunks.size(); ++i) versions[i] = chunks[i].version;
+        chunks.assign(std::size_t(cw) * std::size_t(ch), Chunk{});
+        // Versiones nuevas aunque el contenido coincida: las caches no deben sobrevivir al reset
+        for (std::size_t i = 0; i < chunks.size(); ++i) chunks[i].version = (i < versions.size() ? versions[i] : 0) + 1;
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x) {
+                Chunk& c = at(x >> kSummaryShift, y >> kSummaryShift);
+                const std::uint8_t m = plane[std::size_t(y) * std::size_t(w) + std::size_t(x)];
+                if (c.counts[m]++ == 0) c.present.set(m);
+            }
+    }
+
+    void onWrite(int x, int y, std::uint8_t prev, std::uint8_t m) {
+        Chunk& c = at(x >> kSummaryShift, y >> kSummaryShift);
+        if (--c.counts[prev] == 0) c.present.clear(prev);
+        if (c.counts[m]++ == 0) c.present.set(m);
+        ++c.version;
+    }
+
+    int chunksX() const { return cw; }
+    int chunksY() const { return ch; }
+    const Chunk& at(int cx, int cy) const { return chunks[std::size_t(cy) * std::size_t(cw) + std::size_t(cx)]; }
+
+private:
+    int cw = 0, ch = 0;
+    std::vector<Chunk> chunks;
+
+    Chunk& at(int cx, int cy) { return chunks[std::size_t(cy) * std::size_t(cw) + std::size_t(cx)]; }
+};
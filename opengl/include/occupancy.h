@@ -0,0 +1,141 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Bitboards por fila del plano de materiales: un u64 cubre 64 celdas de una fila.
+//   full:     celda no Empty (para "esta libre debajo?" sin tocar las Cell)
+//   active:   material UpdateClass::Active (step() lo visita siempre)
+//   reactive: material UpdateClass::Reactive (solo si hay un 'wake' en sus 8 vecinos)
+//   wake:     material que puede hacer reaccionar a alguno Reactive
+// Ademas, cuantos bits hay por fila de cada tipo, para que step() salte filas enteras
+// sin mirar sus palabras. Los bits de relleno tras la ultima columna son siempre 0.
+// Lo mantiene el motor desde sus puntos de escritura, como el hash y el MaterialSummary.
+
+inline int lowestBit(std::uint64_t b) {
+#if defined(_MSC_VER)
+    unsigned long i; _BitScanForward64(&i, b); return int(i);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+inline int highestBit(std::uint64_t b) {
+#if defined(_MSC_VER)
+    unsigned long i; _BitScanReverse64(&i, b); return int(i);
+#else
+    return 63 - __builtin_clzll(b);
+#endif
+}
+inline int popCount(std::uint64_t b) {
+#if defined(_MSC_VER)
+    return int(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+class Occupancy {
+public:
+    // Bits por material: se fijan aqui (los materiales se cargan antes del motor)
+    static constexpr std::uint8_t kActive = 1, kReactive = 2, kWake = 4;
+
+    void reset(const std::uint8_t* plane, int w, int h, const std::array<std::uint8_t, 256>& matClass) {
+        words = (w + 63) >> 6;
+        rows = h;
+        cls = matClass;
+        for (Board& b : boards) { b.bits.assign(std::size_t(words) * std::size_t(h), 0); b.count.assign(std::size_t(h), 0); }
+        full.assign(std::size_t(words) * std::size_t(h), 0);
+        for (int y = 0; y < h; ++y) span(y, 0, w, plane + std::size_t(y) * std::size_t(w), 0);
+    }
+
+    void set(int x, int y, std::uint8_t m) {
+        const std::size_t i = std::size_t(y) * std::size_t(words) + std::size_t(x >> 6);
+        const std::uint64_t bit = std::uint64_t(1) << (x & 63);
+        full[i] = m != 0 ? (full[i] | bit) : (full[i] & ~bit);
+        for (int k = 0; k < kBoards; ++k) {
+            Board& b = boards[k];
+            const bool on = (cls[m] >> k) & 1u;
+            if (on == ((b.bits[i] & bit) != 0)) continue;
+            b.bits[i] ^= bit;
+            b.count[std::size_t(y)] += on ? 1 : -1;
+        }
+    }
+
+    // [x0, x1) de la fila y pasa a 'src' (x0..x1-1), o a 'm' en todas si src es null
+    void span(int y, int x0, int x1, const std::uint8_t* src, std::uint8_t m) {
+        if (src) { for (int x = x0; x < x1; ++x) set(x, y, src[x - x0]); return; }
+        const std::size_t row = std::size_t(y) * std::size_t(words);
+        for (int x = x0; x < x1;) {
+            const int wi = x >> 6, lo = x & 63;
+            const int n = std::min(64 - lo, x1 - x);
+            const std::uint64_t mask = (n == 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << n) - 1)) << lo;
+            std::uint64_t& f = full[row + std::size_t(wi)];
+            f = m != 0 ? (f | mask) : (f & ~mask);
+            for (int k = 0; k < kBoards; ++k) {
+                std::uint64_t& b = boards[k].bits[row + std::size_t(wi)];
+                const std::uint64_t was = b;
+                b = ((cls[m] >> k) & 1u) ? (b | mask) : (b & ~mask);
+                boards[k].count[std::size_t(y)] += popCount(b) - popCount(was);
+            }
+            x += n;
+        }
+    }
+
+    // Copia de 'o' las palabras que cubren [x0, x1] de la fila y (mismo tamano)
+    void copyRow(const Occupancy& o, int y, int x0, int x1) {
+        const std::size_t a = std::size_t(y) * std::size_t(words) + std::size_t(x0 >> 6);
+        const std::size_t b = std::size_t(y) * std::size_t(words) + std::size_t(x1 >> 6) + 1;
+        std::copy(o.full.begin() + std::ptrdiff_t(a), o.full.begin() + std::ptrdiff_t(b), full.begin() + std::ptrdiff_t(a));
+        for (int k = 0; k < kBoards; ++k) {
+            int d = 0;
+            for (std::size_t i = a; i < b; ++i) d += popCount(o.boards[k].bits[i]) - popCount(boards[k].bits[i]);
+            std::copy(o.boards[k].bits.begin() + std::ptrdiff_t(a), o.boards[k].bits.begin() + std::ptrdiff_t(b),
+                boards[k].bits.begin() + std::ptrdiff_t(a));
+            boards[k].count[std::size_t(y)] += d;
+        }
+    }
+
+    bool occupied(int x, int y) const {
+        return (full[std::size_t(y) * std::size_t(words) + std::size_t(x >> 6)] >> (x & 63)) & 1u;
+    }
+    int rowWords() const { return words; }
+    const std::uint64_t* activeRow(int y) const { return boards[0].bits.data() + std::size_t(y) * std::size_t(words); }
+    const std::uint64_t* reactiveRow(int y) const { return boards[1].bits.data() + std::size_t(y) * std::size_t(words); }
+
+    int activeCount(int y) const { return boards[0].count[std::size_t(y)]; }
+    // La fila y tiene celdas Reactive con algun 'wake' en las filas y-1..y+1
+    bool rowWoken(int y) const {
+        if (!boards[1].count[std::size_t(y)]) return false;
+        const std::vector<int>& c = boards[2].count;
+        return c[std::size_t(y)] || (y > 0 && c[std::size_t(y - 1)]) || (y + 1 < rows && c[std::size_t(y + 1)]);
+    }
+    // Celdas de la palabra wi de la fila y con un 'wake' entre sus 8 vecinos (o en ella)
+    std::uint64_t wakeHalo(int y, int wi) const {
+        auto col = [&](int i) -> std::uint64_t {
+            if (i < 0 || i >= words) return 0;
+            const std::uint64_t* t = boards[2].bits.data() + std::size_t(i);
+            std::uint64_t v = t[std::size_t(y) * std::size_t(words)];
+            if (y > 0) v |= t[std::size_t(y - 1) * std::size_t(words)];
+            if (y + 1 < rows) v |= t[std::size_t(y + 1) * std::size_t(words)];
+            return v;
+        };
+        const std::uint64_t c = col(wi);
+        return c | (c << 1) | (c >> 1) | (col(wi - 1) >> 63) | (col(wi + 1) << 63);
+    }
+
+private:
+    static constexpr int kBoards = 3;   // active, reactive, wake (mismo orden que los bits)
+    struct Board {
+        std::vector<std::uint64_t> bits;
+        std::vector<int> count;         // bits a 1 por fila
+    };
+    int words = 0, rows = 0;
+    std::array<std::uint8_t, 256> cls{};
+    std::vector<std::uint64_t> full;
+    Board boards[kBoards];
+};
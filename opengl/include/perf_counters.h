@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+
+// Contadores hardware del hilo que llama (perf_event_open, solo Linux): ciclos,
+// instrucciones, fallos de L1d/LLC, de prediccion de saltos y de dTLB. Cada evento va
+// por separado, asi que si el PMU no tiene alguno (maquina virtual, contenedor) el
+// resto sigue; con perf_event_paranoid alto o sin la syscall, open() falla y error()
+// dice por que. Solo modo usuario: el coste de leerlos no entra en la medida.
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, L1dMiss, LlcMiss, BranchMiss, DtlbMiss, kEvents };
+    static const char* name(int e);
+
+    struct Snapshot {
+        std::uint64_t value[kEvents] = {}, enabled[kEvents] = {}, running[kEvents] = {};
+        // false si el evento no esta abierto o su read() fallo o se quedo corto
+        bool valid[kEvents] = {};
+    };
+    // Suma de los deltas entre pares de lecturas (p. ej. una por fase de tick); un par
+    // con alguna lectura no valida no suma nada para ese evento
+    struct Totals {
+        Snapshot sum;
+        void add(const Snapshot& from, const Snapshot& to);
+        bool counted(int e) const { return sum.running[e] != 0; }
+        // Si el kernel multiplexo el evento, escalado a todo el tiempo medido
+        double value(int e) const;
+    };
+
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    // true si se abrio al menos un evento
+    bool open();
+    const char* error() const { return err; }
+    bool has(int e) const { return fd[e] >= 0; }
+
+    void read(Snapshot& s) const;
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+private:
+    int fd[kEvents] = { -1, -1, -1, -1, -1, -1 };
+    const char* err = nullptr;
+};
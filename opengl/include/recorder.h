@@ -0,0 +1,108 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Engine;
+
+// Formato .fsr: cabecera + registros {tipo, tick, rect, hash, payload}.
+//  - keyframe: plano completo codificado con RLE
+//  - delta: XOR contra el plano anterior dentro del dirty-rect, con RLE
+// El RLE distingue rachas de ceros (lo normal en un XOR), rachas repetidas y literales.
+
+// Graba el plano de materiales. capture() corre en el hilo de simulacion y solo
+// codifica el dirty-rect; la escritura a disco va en un hilo aparte con cola acotada.
+// Si la cola se llena se descarta el registro y el siguiente se fuerza a keyframe,
+// asi el hilo de simulacion nunca espera al disco y el fichero sigue siendo coherente.
+class DeltaRecorder {
+public:
+    ~DeltaRecorder() { close(); }
+
+    bool open(const char* path, int gridW, int gridH, int keyframeInterval = 240,
+        size_t maxQueuedBytes = size_t(32) << 20);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // Una vez por tick: tras tick() (headless) o como TickObserver de update(); debe ir
+    // antes de takeDirtyRect()
+    void capture(const Engine& e);
+
+    std::uint64_t records() const { return recordCount; }
+    std::uint64_t dropped() const { return droppedCount; }
+    std::uint64_t bytesEncoded() const { return encodedBytes; }
+
+private:
+    std::FILE* file = nullptr;
+    int w = 0, h = 0;
+    int keyInterval = 240;
+    size_t maxQueued = 0;
+
+    std::vector<std::uint8_t> prev;     // plano del ultimo registro
+    std::vector<std::uint8_t> scratch;  // XOR del rect
+    bool haveKey = false;
+    bool forceKey = true;
+    std::uint64_t lastKeyTick = 0;
+    std::uint64_t recordCount = 0, droppedCount = 0, encodedBytes = 0;
+
+    // Cola hacia el hilo escritor; los buffers se reciclan para no asignar por tick
+    std::thread writer;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::vector<std::uint8_t>> queue, freeList;
+    size_t queuedBytes = 0;
+    bool stopping = false;
+
+    void writerLoop();
+    std::vector<std::uint8_t> takeBuffer();
+};
+
+// Reproduce un .fsr: salta al keyframe anterior y aplica deltas hasta el tick pedido.
+class DeltaPlayer {
+public:
+    ~DeltaPlayer() { close(); }
+
+    bool open(const char* path);
+    void close();
+
+    int width() const { return w; }
+    int height() const { return h; }
+    size_t recordCount() const { return index.size(); }
+    std::uint64_t firstTick() const { return index.empty() ? 0 : index.front().tick; }
+    std::uint64_t lastTick() const { return index.empty() ? 0 : index.back().tick; }
+
+    // Reconstruye el ultimo registro con tick <= t; false si t es anterior al primero
+    bool seek(std::uint64_t t);
+    bool next();    // siguiente registro
+
+    std::uint64_t tick() const { return cur >= 0 ? index[size_t(cur)].tick : 0; }
+    const std::uint8_t* plane() const { return planeBuf.data(); }
+
+    // Verificacion: hash del plano reconstruido (incremental) y el que grabo el motor
+    bool hasHashes() const { return hashed; }
+    std::uint64_t hash() const { return planeHash; }
+    std::uint64_t recordedHash() const { return cur >= 0 ? index[size_t(cur)].hash : 0; }
+
+private:
+    struct Entry {
+        long offset;            // posicion del payload
+        std::uint64_t tick;
+        std::uint32_t x, y, rw, rh, bytes;
+        std::uint64_t hash;
+        bool key;
+        int keyIndex;           // keyframe del que depende
+    };
+
+    std::FILE* file = nullptr;
+    int w = 0, h = 0;
+    std::vector<Entry> index;
+    std::vector<std::uint8_t> planeBuf, payload, rectBuf;
+    long cur = -1;
+    bool hashed = false;
+    std::uint64_t planeHash = 0;
+
+    bool apply(size_t i);
+};
@@ -3,11 +3,47 @@
 #include <cstdint>
 #include "material.h"
 
+// Calidad ajustable en caliente (ver FrameGovernor)
+struct RenderQuality {
+    bool bloom = true;
+    int bloomDiv = 1;           // resolución del bloom = viewport / bloomDiv
+    int bloomPasses = 6;        // pasadas de blur (pares: H+V)
+    bool cellEffects = true;    // discos con borde suave + variación de color por celda
+};
+
 class Renderer {
 public:
     Renderer();
     ~Renderer();
 
+    void setQuality(const RenderQuality& q) {
+        if (q.cellEffects != quality.cellEffects) cellValid = false;   // el tinte va en la caché
+        quality = q;
+    }
+    // Caché de color por celda (por defecto): el sombreado por material se resuelve
+    // solo en los dirty-rects a una textura del tamaño de la rejilla. false = grid.fs.glsl
+    void setCellCache(bool on) { cellCache = on; cellValid = false; }
+    // Rejilla en un array de teselas (GL_TEXTURE_2D_ARRAY) en vez de una sola textura:
+    // los dirty-rects se trocean por tesela y las que caen fuera de la vista no se suben
+    // hasta que entran. 0 = solo si la rejilla pasa de GL_MAX_TEXTURE_SIZE (por defecto);
+    // > 0 = siempre, con teselas de ese lado (pruebas). Sin caché de color por celda:
+    // cellTex sería igual de grande que la rejilla
+    void setTiledTextures(int tileSize) {
+        if (tileSize == tileForce) return;
+        tileForce = tileSize; tileGridW = tileGridH = 0;
+        // Mientras se usaba el otro modo, tex y cellTex no recibieron los dirty-rects
+        texValid = false; cellValid = false;
+    }
+    bool tiledTextures() const { return tiled; }
+    const RenderQuality& currentQuality() const { return quality; }
+
+    // Zonas de la rejilla que pueden brillar (rects {x, y, w, h} en celdas, p. ej.
+    // Engine::emissiveRects()): threshold y blur se recortan con scissor a esas zonas
+    // más el radio del blur. n = 0 salta el bloom entero; n < 0 vuelve a pantalla
+    // completa (por defecto). Se copian; vale hasta la siguiente llamada
+    static constexpr int kMaxBloomRects = 16;
+    void setBloomRegions(const int* xywh, int n);
+
     // Fallback (sube todo desde Cells)
     void draw(const std::vector<Cell>& cells, int w, int h, int viewW, int viewH);
 
@@ -15,8 +51,8 @@ public:
     void drawPlane(const std::uint8_t* planeM, int w, int h,
         int viewW, int viewH, int x0, int y0, int rw, int rh);
 
-    // Útil si quieres subir todo el plano SoA directamente
-    void drawGrid(const std::vector<uint8_t>& indices, int w, int h, int viewW, int viewH);
+    // Útil si quieres subir todo el plano SoA directamente (null = no sube nada)
+    void drawGrid(const std::uint8_t* indices, int w, int h, int viewW, int viewH);
 
 private:
     // --- Grid pass (índices → color con paleta UBO + discos) ---
@@ -29,6 +65,31 @@ private:
     int loc_uTex = -1;
     int loc_uGrid = -1;
     int loc_uView = -1;
+    int loc_uEffects = -1;
+
+    // --- Caché de color por celda (RGBA16F, resolución de rejilla) ---
+    bool cellCache = true;
+    unsigned int progResolve = 0, progGridCached = 0;
+    unsigned int cellFBO = 0, cellTex = 0;
+    int cellW = 0, cellH = 0;
+    bool cellValid = false;
+    // Unión de lo subido desde el último resolve (x0,y0,x1,y1 inclusive)
+    int pendX0 = 0, pendY0 = 0, pendX1 = -1, pendY1 = -1;
+    int loc_rs_uTex = -1, loc_rs_uGrid = -1, loc_rs_uEffects = -1;
+    int loc_gc_uCells = -1, loc_gc_uGrid = -1, loc_gc_uView = -1, loc_gc_uEffects = -1;
+
+    RenderQuality quality;
+
+    // --- Rejilla por teselas (R8UI, una capa por tesela: ty * tilesX + tx) ---
+    int maxTexSize = 0, maxTexLayers = 0;
+    int tileForce = 0;
+    bool tiled = false;                 // el último drawGrid usó las teselas
+    unsigned int progGridTiled = 0, tileTex = 0;
+    int tileSize = 0, tilesX = 0, tilesY = 0, tileGridW = 0, tileGridH = 0;
+    int visTX0 = 0, visTY0 = 0, visTX1 = 0, visTY1 = 0;    // teselas en vista, [0, 1)
+    std::vector<std::uint8_t> tileStale;   // desfasada: se sube entera al entrar en vista
+    int loc_gt_uTiles = -1, loc_gt_uTileSize = -1, loc_gt_uTilesX = -1;
+    int loc_gt_uGrid = -1, loc_gt_uView = -1, loc_gt_uEffects = -1;
 
     // --- PBO doble para uploads ---
     unsigned int pbo[2] = { 0,0 };
@@ -44,17 +105,35 @@ private:
     unsigned int sceneFBO = 0, sceneTex = 0;
     unsigned int pingFBO[2] = { 0,0 }, pingTex[2] = { 0,0 };
     int fboW = 0, fboH = 0;
+    int bloomW = 0, bloomH = 0, bloomDiv = 0;   // ping-pong a resolución reducida
+    int bloomRects[4 * kMaxBloomRects] = {};    // en celdas, ver setBloomRegions
+    int bloomRectCount = -1;
 
-    // CPU buffers
-    std::vector<uint8_t> scratch;     // full
-    std::vector<uint8_t> scratchRect; // rect
+    // CPU buffer del fallback draw(); drawPlane copia el rect directo al PBO
+    std::vector<uint8_t> scratch;
 
     void ensureGL();
     void initOnce();
     void ensureSceneTargets(int viewW, int viewH);
+    void ensureCellTarget(int w, int h);
+    void addPending(int x0, int y0, int rw, int rh);
+    void resolveCells(int w, int h);
+
+    bool wantTiles(int w, int h) const {
+        return tileForce > 0 || w > maxTexSize || h > maxTexSize;
+    }
+    void ensureTileTarget(int w, int h);
+    void updateVisibleTiles(int w, int h, int viewW, int viewH);
+    // Sube el rect (x0,y0,rw,rh) de un plano w x h a las teselas en vista y después las
+    // desfasadas que hayan entrado en vista
+    void syncTiles(const std::uint8_t* plane, int w, int h, int viewW, int viewH,
+        int x0, int y0, int rw, int rh);
+    // bloomRects -> rects de scissor en texels del bloom (x, y, w, h); devuelve cuántos
+    int bloomScissors(int* out, int w, int h, int viewW, int viewH) const;
 
     void uploadFullCPU(const std::uint8_t* img, int w, int h);
-    void uploadRectPBO(const std::uint8_t* src, int rw, int rh, int x0, int y0,
+    // src apunta a (x0,y0) de un plano con filas de srcStride bytes
+    void uploadRectPBO(const std::uint8_t* src, int srcStride, int rw, int rh, int x0, int y0,
         int texWNeeded, int texHNeeded);
 
     // draws a full-screen triangle with the currently bound program & textures
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class Engine;
+
+// Escena aleatoria pero reproducible: pinceladas de los materiales de serie
+void seedRandomScene(Engine& e, std::uint32_t seed);
+
+// Escena guardada por el prototipo Python (python/saved/*.txt): una fila de ids por
+// linea. Los ids se traducen a los materiales del motor; los desconocidos quedan vacios.
+bool loadPythonScene(const char* path, std::vector<std::uint8_t>& out, int& w, int& h);
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Disposicion del segmento POSIX compartido entre ShmPublisher y ShmReader.
+//
+//   [ShmHeader][slot 0: ShmSlot + plano][slot 1] ... [slot N-1]
+//
+// Cada slot es un seqlock: el productor pone seq impar, escribe y lo deja par.
+// El lector copia y solo acepta el frame si seq no cambio y era par.
+// El productor nunca espera a los lectores; un lector lento solo reintenta.
+
+static constexpr char kShmMagic[8] = { 'F', 'S', 'S', 'H', 'M', '0', '0', '1' };
+static constexpr std::uint32_t kShmVersion = 1;
+
+struct ShmHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t width, height;
+    std::uint32_t slots;
+    std::uint64_t slotStride;           // bytes entre slots (cabecera + plano, alineado a 64)
+    std::atomic<std::uint64_t> latest;  // ultimo frame publicado (1..), 0 = ninguno
+};
+
+struct ShmSlot {
+    std::atomic<std::uint64_t> seq;
+    std::uint64_t frame;
+    std::uint64_t tick;
+    std::int32_t dirtyX, dirtyY, dirtyW, dirtyH; // rect cambiado desde el frame anterior
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "el seqlock necesita atomics sin lock");
+
+static constexpr std::size_t kShmHeaderBytes = 64;
+static constexpr std::size_t kShmSlotHeaderBytes = 64;
+static_assert(sizeof(ShmHeader) <= kShmHeaderBytes && sizeof(ShmSlot) <= kShmSlotHeaderBytes, "cabeceras > 64B");
+
+inline std::uint64_t shmSlotStride(int w, int h) {
+    std::uint64_t plane = (std::uint64_t(w) * std::uint64_t(h) + 63u) & ~std::uint64_t(63u);
+    return kShmSlotHeaderBytes + plane;
+}
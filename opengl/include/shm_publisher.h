@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "shm_frames.h"
+
+class Engine;
+
+// Publica el plano de materiales en un anillo de frames en memoria compartida POSIX
+// (/dev/shm/<nombre>). Sin serializacion: el plano se copia tal cual al slot, y
+// beginFrame()/endFrame() permiten escribir directamente en el slot sin copia intermedia.
+class ShmPublisher {
+public:
+    ~ShmPublisher() { close(); }
+
+    // Crea el segmento desde cero (reemplaza uno existente con el mismo nombre)
+    bool create(const char* name, int gridW, int gridH, int slots = 4);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    // Copia planeM() y el dirty-rect pendiente (sin consumirlo: llamar antes del take)
+    void publish(const Engine& e);
+
+    // Escritura directa: devuelve el plano del slot siguiente; endFrame() lo hace visible
+    std::uint8_t* beginFrame();
+    void endFrame(std::uint64_t tick, int dx, int dy, int dw, int dh);
+
+    std::uint64_t frames() const { return frameCount; }
+
+private:
+    std::string shmName;
+    ShmHeader* header = nullptr;
+    std::uint8_t* base = nullptr;
+    std::size_t mapBytes = 0;
+    int w = 0, h = 0, nSlots = 0;
+    std::uint64_t frameCount = 0;
+    ShmSlot* writing = nullptr;
+
+    ShmSlot* slotAt(std::uint64_t frame) const;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "shm_frames.h"
+
+// Lado lector del anillo de ShmPublisher. Cualquier numero de procesos puede abrirlo;
+// la lectura nunca bloquea al productor.
+struct ShmFrameInfo {
+    std::uint64_t frame = 0;
+    std::uint64_t tick = 0;
+    int dirtyX = 0, dirtyY = 0, dirtyW = 0, dirtyH = 0;
+};
+
+class ShmReader {
+public:
+    ~ShmReader() { close(); }
+
+    bool open(const char* name);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    int width() const { return w; }
+    int height() const { return h; }
+    std::uint64_t latestFrame() const;
+
+    // Copia coherente del ultimo frame en 'out'. false si aun no hay frames o si el
+    // productor lo sobrescribio 'retries' veces seguidas mientras se copiaba.
+    bool readLatest(std::vector<std::uint8_t>& out, ShmFrameInfo& info, int retries = 16) const;
+
+private:
+    const ShmHeader* header = nullptr;
+    const std::uint8_t* base = nullptr;
+    std::size_t mapBytes = 0;
+    int w = 0, h = 0, nSlots = 0;
+    std::uint64_t stride = 0;
+};
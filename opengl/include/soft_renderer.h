@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "material.h"
+
+// Renderer por CPU (sin GL): expande el plano de materiales a RGBA8 con la misma
+// paleta, variacion por celda (hash2 de grid.fs.glsl) y tonemap que el camino GL
+// sin bloom. Con scale > 1 cada celda es un disco como en el shader.
+class SoftRenderer {
+public:
+    SoftRenderer(int scale = 1);
+
+    // Relee matProps (llamar si se recargan los materiales)
+    void rebuildPalette();
+
+    // Redibuja solo el rect sucio; si cambia el tamano de la rejilla, todo
+    void update(const std::uint8_t* planeM, int w, int h, int x0, int y0, int rw, int rh);
+    void updateFull(const std::uint8_t* planeM, int w, int h) { update(planeM, w, h, 0, 0, w, h); }
+
+    int width() const { return fbW; }
+    int height() const { return fbH; }
+    int scale() const { return s; }
+    // RGBA8 por pixel (r en el byte bajo), filas de arriba a abajo
+    const std::uint32_t* pixels() const { return fb.data(); }
+
+private:
+    static constexpr int kTintLevels = 64;
+
+    int s = 1;
+    int gridW = 0, gridH = 0;
+    int fbW = 0, fbH = 0;
+    std::vector<std::uint32_t> fb;
+    std::vector<std::uint8_t> tint;          // nivel de tinte por celda (fijo por tamano)
+    std::vector<std::uint32_t> lut;          // [material * kTintLevels + tinte] -> RGBA8
+    std::vector<std::uint8_t> discClass;     // s*s: indice de cobertura del disco por sub-pixel
+    std::vector<std::uint8_t> discLevels;    // cobertura (0..255) de cada clase
+    std::vector<std::uint32_t> discLut;      // lut con la cobertura de cada clase (mezcla antes del tonemap)
+    std::uint32_t background = 0;
+
+    void resize(int w, int h);
+    void shadeRows(const std::uint8_t* planeM, int x0, int y0, int rw, int rh);
+};
+
+// ----------------------------- salida -----------------------------
+bool writePPM(const char* path, const std::uint32_t* rgba, int w, int h);
+bool writePNG(const char* path, const std::uint32_t* rgba, int w, int h);
+
+// Video YUV4MPEG2 (4:2:0), lo leen ffmpeg/mpv directamente
+class Y4MWriter {
+public:
+    ~Y4MWriter() { close(); }
+    bool open(const char* path, int w, int h, int fps);
+    bool writeFrame(const std::uint32_t* rgba);
+    void close();
+
+private:
+    std::FILE* f = nullptr;
+    int w = 0, h = 0;
+    std::vector<std::uint8_t> yuv;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "material_summary.h"
+
+class Engine;
+
+// Consultas espaciales sobre el plano de materiales sin recorrer celda a celda:
+// los chunks que no pueden coincidir (mascara vacia) se descartan enteros y los
+// totalmente cubiertos se resuelven con sus conteos. Solo los chunks del borde de
+// la region miran celdas, o su tabla de suma acumulada si useSAT.
+//
+// Requiere engine.enableSummary(true). Consultar entre ticks.
+class SpatialQuery {
+public:
+    explicit SpatialQuery(const Engine& e);
+
+    // Celdas del material m (o de cualquiera de 'mats') en el rect [x, x+rw) x [y, y+rh)
+    int count(int x, int y, int rw, int rh, std::uint8_t m) const;
+    int count(int x, int y, int rw, int rh, const MaterialMask& mats) const;
+
+    // Hay alguna celda de 'mats' en el rect / en el circulo de radio r
+    bool anyOf(int x, int y, int rw, int rh, const MaterialMask& mats) const;
+    bool anyWithin(int cx, int cy, int r, const MaterialMask& mats) const;
+
+    // Celda de 'mats' mas cercana a (x,y) (distancia euclidea) hasta maxRadius
+    bool nearest(int x, int y, const MaterialMask& mats, int maxRadius, int& outX, int& outY) const;
+
+    // Las SAT por (chunk, material) se construyen al consultar y se reconstruyen
+    // solo si el chunk cambio desde entonces. Sin ellas se cuentan las celdas.
+    bool useSAT = true;
+
+private:
+    struct SAT {
+        std::uint32_t version = 0;
+        std::uint16_t sum[(kSummaryChunk + 1) * (kSummaryChunk + 1)];
+    };
+
+    const Engine& engine;
+    mutable std::unordered_map<std::uint32_t, SAT> satCache;
+
+    int countInChunk(int cx, int cy, int x0, int y0, int x1, int y1, std::uint8_t m) const;
+    bool anyInChunk(int x0, int y0, int x1, int y1, const MaterialMask& mats) const;
+    const SAT& sat(int cx, int cy, std::uint8_t m) const;
+    const MaterialSummary& summary() const;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <vector>
 #include <cstdint>
 
@@ -44,6 +45,8 @@ private:
 
 
 	
+	// Reservado en init() a la capacidad del VBO; no crece durante los frames
+	static constexpr size_t kVboBytes = 4 * 1024 * 1024;
 	std::vector<Vertex> verts;
 	int vw = 0, vh = 0;
 
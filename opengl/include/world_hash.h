@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Hash Zobrist del plano de materiales: XOR de una clave por (celda, material).
+// La clave se calcula (splitmix64) en vez de tabularse: 256 x celdas no cabria en cache.
+// Empty tiene clave 0, asi un mundo vacio hashea a 0.
+
+static constexpr int kHashChunkShift = 5;               // sub-hashes por chunk de 32x32
+static constexpr int kHashChunk = 1 << kHashChunkShift;
+
+inline std::uint64_t zobristKey(std::size_t cell, std::uint8_t m) {
+    if (m == 0) return 0;
+    std::uint64_t z = ((std::uint64_t(cell) << 8) | m) + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Delta de hash de cambiar la celda de 'from' a 'to'
+inline std::uint64_t zobristDelta(std::size_t cell, std::uint8_t from, std::uint8_t to) {
+    return zobristKey(cell, from) ^ zobristKey(cell, to);
+}
+
+// Hash completo (recorrido entero): referencia para verificar el incremental
+inline std::uint64_t hashPlane(const std::uint8_t* plane, int w, int h) {
+    std::uint64_t hsh = 0;
+    const std::size_t n = std::size_t(w) * std::size_t(h);
+    for (std::size_t i = 0; i < n; ++i) hsh ^= zobristKey(i, plane[i]);
+    return hsh;
+}
@@ -0,0 +1,73 @@
+#include "alloc_count.h"
+
+#ifdef FS_ALLOC_COUNT
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<std::uint64_t> g_allocs{ 0 }, g_bytes{ 0 };
+
+static void* countedAlloc(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(n, std::memory_order_relaxed);
+    return std::malloc(n ? n : 1);
+}
+
+static void* countedAlignedAlloc(std::size_t n, std::size_t a) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(n, std::memory_order_relaxed);
+#if defined(_MSC_VER)
+    return _aligned_malloc(n ? n : 1, a);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, a < sizeof(void*) ? sizeof(void*) : a, n ? n : 1) == 0 ? p : nullptr;
+#endif
+}
+
+static void alignedFree(void* p) {
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t n) {
+    if (void* p = countedAlloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) {
+    if (void* p = countedAlloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return countedAlloc(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return countedAlloc(n); }
+void* operator new(std::size_t n, std::align_val_t a) {
+    if (void* p = countedAlignedAlloc(n, std::size_t(a))) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n, std::align_val_t a) {
+    if (void* p = countedAlignedAlloc(n, std::size_t(a))) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+
+bool allocCountEnabled() { return true; }
+std::uint64_t allocCount() { return g_allocs.load(std::memory_order_relaxed); }
+std::uint64_t allocBytes() { return g_bytes.load(std::memory_order_relaxed); }
+
+#else
+
+bool allocCountEnabled() { return false; }
+std::uint64_t allocCount() { return 0; }
+std::uint64_t allocBytes() { return 0; }
+
+#endif
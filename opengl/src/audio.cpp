@@ -6,6 +6,7 @@
 bool Audio::init() {
     if (ready) return true;
     ready = (ma_engine_init(NULL, &eng) == MA_SUCCESS);
+    events.reserve(256);
 
     loadAudios();
 
@@ -29,9 +30,9 @@ void Audio::shutdown() {
 }
 
 void Audio::update(Engine& E) {
-    std::vector<AudioEvent> evs;
-    if (E.takeAudioEvents(evs)) {
-        for (const auto& e : evs) {
+    events.clear();
+    if (E.takeAudioEvents(events)) {
+        for (const auto& e : events) {
 
             float x01 = float(e.x) / float(E.width());
             float y01 = float(e.y) / float(E.height());
@@ -0,0 +1,163 @@
+#include "batch.h"
+#include <algorithm>
+#include <chrono>
+
+std::uint32_t BatchRunner::worldSeed(std::uint32_t baseSeed, int i) {
+    // Semilla distinta por mundo (golden ratio) para barridos reproducibles
+    return baseSeed + std::uint32_t(i) * 0x9E3779B9u;
+}
+
+BatchRunner::BatchRunner(int nWorlds, int gridW, int gridH, int threads, std::uint32_t baseSeed, SimMode mode,
+    GridLayout layout) {
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, std::max(1, nWorlds)));
+
+    worlds.reserve(size_t(nWorlds));
+    for (int i = 0; i < nWorlds; ++i) {
+        worlds.push_back(std::make_unique<Engine>(gridW, gridH, worldSeed(baseSeed, i), mode, layout));
+        worlds.back()->audioEnabled = false;
+    }
+    worldStats.resize(size_t(nWorlds));
+    remaining.assign(size_t(nWorlds), 0);
+
+    for (int i = 0; i < threads; ++i) queues.push_back(std::make_unique<Queue>());
+    for (int i = 0; i < threads; ++i) pool.emplace_back(&BatchRunner::workerLoop, this, i);
+}
+
+BatchRunner::~BatchRunner() {
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto& t : pool) t.join();
+}
+
+void BatchRunner::step(int ticks) {
+    if (ticks <= 0 || worlds.empty()) return;
+
+    // Reparto inicial round-robin; el equilibrado real lo hace el robo
+    for (int i = 0; i < size(); ++i) {
+        remaining[i] = ticks;
+        Queue& q = *queues[size_t(i) % queues.size()];
+        std::lock_guard<std::mutex> lk(q.mtx);
+        q.items.push_back(i);
+    }
+    queued.store(size(), std::memory_order_release);
+    pendingWorlds.store(size(), std::memory_order_release);
+
+    std::unique_lock<std::mutex> lk(mtx);
+    ++generation;
+    busyWorkers = (int)pool.size();
+    wake.notify_all();
+    done.wait(lk, [&] { return busyWorkers == 0; });
+}
+
+void BatchRunner::snapshot(int i, std::vector<std::uint8_t>& out) const {
+    const Engine& e = *worlds[i];
+    const size_t n = size_t(e.width()) * size_t(e.height());
+    out.assign(e.planeM(), e.planeM() + n);
+}
+
+bool BatchRunner::popOrSteal(int id, int& world) {
+    // Propia cola por delante (LIFO caliente en cache), ajenas por detras
+    {
+        Queue& q = *queues[id];
+        std::lock_guard<std::mutex> lk(q.mtx);
+        if (!q.items.empty()) {
+            world = q.items.back(); q.items.pop_back();
+            queued.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+    const int n = (int)queues.size();
+    for (int k = 1; k < n; ++k) {
+        Queue& q = *queues[(id + k) % n];
+        std::lock_guard<std::mutex> lk(q.mtx);
+        if (!q.items.empty()) {
+            world = q.items.front(); q.items.pop_front();
+            queued.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Tomar idleMtx antes de avisar: un hilo que ya comprobo el predicado esta dentro de
+// wait() cuando se consigue el mutex, asi que el aviso no se pierde
+void BatchRunner::wakeIdle(bool all) {
+    std::lock_guard<std::mutex> lk(idleMtx);
+    if (sleepers == 0) return;
+    if (all) idle.notify_all();
+    else idle.notify_one();
+}
+
+void BatchRunner::runSlice(int wi) {
+    Engine& e = *worlds[wi];
+    WorldStats& st = worldStats[wi];
+    const int n = std::min(sliceTicks, remaining[wi]);
+
+    auto t0 = std::chrono::steady_clock::now();
+    int x, y, rw, rh;
+    for (int t = 0; t < n; ++t) {
+        e.tick();
+        if (e.takeDirtyRect(x, y, rw, rh)) st.dirtyCells += std::uint64_t(rw) * std::uint64_t(rh);
+        else ++st.quietTicks;
+    }
+    st.hash = e.stateHash();
+    st.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    st.ticks += std::uint64_t(n);
+    remaining[wi] -= n;
+
+    if (remaining[wi] == 0) {
+        st.counts.fill(0);
+        const std::uint8_t* p = e.planeM();
+        const size_t cells = size_t(e.width()) * size_t(e.height());
+        for (size_t i = 0; i < cells; ++i) ++st.counts[p[i]];
+    }
+}
+
+void BatchRunner::workerLoop(int id) {
+    std::uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(mtx);
+            wake.wait(lk, [&] { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+        }
+
+        while (pendingWorlds.load(std::memory_order_acquire) > 0) {
+            int wi;
+            if (!popOrSteal(id, wi)) {
+                std::unique_lock<std::mutex> lk(idleMtx);
+                ++sleepers;
+                idle.wait(lk, [&] {
+                    return pendingWorlds.load(std::memory_order_acquire) == 0 || queued.load(std::memory_order_acquire) > 0;
+                });
+                --sleepers;
+                continue;
+            }
+            runSlice(wi);
+            if (remaining[wi] > 0) {
+                size_t mine;
+                {
+                    Queue& q = *queues[id];
+                    std::lock_guard<std::mutex> lk(q.mtx);
+                    q.items.push_back(wi);
+                    queued.fetch_add(1, std::memory_order_acq_rel);
+                    mine = q.items.size();
+                }
+                // Con un solo mundo en la cola este hilo lo retoma enseguida: despertar a
+                // otro solo serviria para pelearselo
+                if (mine > 1) wakeIdle(false);
+            }
+            else if (pendingWorlds.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                wakeIdle(true);
+            }
+        }
+
+        std::lock_guard<std::mutex> lk(mtx);
+        if (--busyWorkers == 0) done.notify_one();
+    }
+}
@@ -1,6 +1,7 @@
 ﻿#include "engine.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <vector>
 #include <string>
 
@@ -14,17 +15,66 @@ bool Engine::randbit(int x, int y, int parity) {
 }
 
 // ---------------------------- ctor ----------------------------
-Engine::Engine(int gridW, int gridH) : w(gridW), h(gridH) {
-    front.assign(w * h, Cell{ (u8)Material::Empty,0 });
-    back.assign(w * h, Cell{ (u8)Material::Empty,0 });
+Engine::Engine(int gridW, int gridH, std::uint32_t seed, SimMode mode, GridLayout layout)
+    : w(gridW), h(gridH), simMode(mode), cellLayout(layout), rng(seed ? seed : 0x9E3779B9u) {
+    hcw = (w + kHashChunk - 1) >> kHashChunkShift;
+    hch = (h + kHashChunk - 1) >> kHashChunkShift;
+    buildLayout();
     mFront.assign(w * h, (u8)Material::Empty);
     mBack.assign(w * h, (u8)Material::Empty);
-    registerDefaultMaterials();
+    ensureMaterials();
+    resetOccupancy();
+    syncLo.assign(size_t(h), w);
+    syncHi.assign(size_t(h), -1);
+    audioEvents.reserve(kMaxAudioEvents);
     // Dirty-rect: forzar upload completo inicial
     clearDirty();
     markDirtyRect(0, 0, w - 1, h - 1);
 }
 
+// Tablas de cellIdx. Las Cell ocupan (w+2) x (h+2): un anillo de NullCell rodea la
+// rejilla para que los kernels lean vecinos y prueben movimientos sin comprobar rango.
+// En los tres layouts el indice se separa en una parte que solo depende de y y otra
+// que solo depende de x (X = x+1, Y = y+1): en tesela, (Y>>3, Y&7) y (X>>3, X&7); en
+// Morton, los bits de X&7 e Y&7 intercalados no se pisan. Las teselas del borde se
+// reservan enteras.
+void Engine::buildLayout() {
+    const int W = w + 2, H = h + 2;
+    rowOff.assign(size_t(H), 0);
+    colOff.assign(size_t(W), 0);
+    size_t cells = size_t(W) * size_t(H);
+    if (cellLayout == GridLayout::Linear) {
+        runMask = -1;
+        stride = W;
+        ringBase = W + 1;
+        for (int Y = 0; Y < H; ++Y) rowOff[size_t(Y)] = Y * W;
+        for (int X = 0; X < W; ++X) colOff[size_t(X)] = X;
+    }
+    else {
+        const int tilesX = (W + 7) >> 3, tilesY = (H + 7) >> 3;
+        cells = size_t(tilesX) * size_t(tilesY) * 64;
+        const bool z = cellLayout == GridLayout::Morton;
+        // Bits 0..2 repartidos en posiciones pares (x) o impares (y)
+        auto spread = [](int v) { return (v & 1) | ((v & 2) << 1) | ((v & 4) << 2); };
+        runMask = z ? 1 : 7;
+        for (int Y = 0; Y < H; ++Y)
+            rowOff[size_t(Y)] = (Y >> 3) * tilesX * 64 + (z ? spread(Y & 7) << 1 : (Y & 7) * 8);
+        for (int X = 0; X < W; ++X)
+            colOff[size_t(X)] = (X >> 3) * 64 + (z ? spread(X & 7) : (X & 7));
+    }
+    front.assign(cells, Cell{ (u8)Material::Empty,0 });
+    back.assign(cells, Cell{ (u8)Material::Empty,0 });
+    const Cell wall{ (u8)Material::NullCell };
+    for (int x = -1; x <= w; ++x) {
+        front[size_t(cellIdx(x, -1))] = back[size_t(cellIdx(x, -1))] = wall;
+        front[size_t(cellIdx(x, h))] = back[size_t(cellIdx(x, h))] = wall;
+    }
+    for (int y = 0; y < h; ++y) {
+        front[size_t(cellIdx(-1, y))] = back[size_t(cellIdx(-1, y))] = wall;
+        front[size_t(cellIdx(w, y))] = back[size_t(cellIdx(w, y))] = wall;
+    }
+}
+
 // ---------------------- dirty helpers -------------------------
 void Engine::clearDirty() {
     dirtyMinX = w; dirtyMinY = h;
@@ -32,6 +82,9 @@ void Engine::clearDirty() {
 }
 void Engine::markDirty(int x, int y) {
     if (!inRange(x, y)) return;
+    if (touchOn) touch(x, y);
+    if (lodOn) lodSched.note(x, y);
+    markSync(y, x, x);
     if (x < dirtyMinX) dirtyMinX = x;
     if (y < dirtyMinY) dirtyMinY = y;
     if (x > dirtyMaxX) dirtyMaxX = x;
@@ -43,33 +96,212 @@ void Engine::markDirtyRect(int x0, int y0, int x1, int y1) {
     x1 = std::max(0, std::min(x1, w - 1));
     y1 = std::max(0, std::min(y1, h - 1));
     if (x1 < x0 || y1 < y0) return;
+    if (touchOn) touchRect(x0, y0, x1, y1);
+    if (lodOn) lodSched.noteRect(x0, y0, x1, y1);
+    for (int y = y0; y <= y1; ++y) markSync(y, x0, x1);
     if (x0 < dirtyMinX) dirtyMinX = x0;
     if (y0 < dirtyMinY) dirtyMinY = y0;
     if (x1 > dirtyMaxX) dirtyMaxX = x1;
     if (y1 > dirtyMaxY) dirtyMaxY = y1;
 }
-bool Engine::takeDirtyRect(int& x, int& y, int& rw, int& rh) {
+bool Engine::peekDirtyRect(int& x, int& y, int& rw, int& rh) const {
     if (dirtyMaxX < dirtyMinX || dirtyMaxY < dirtyMinY) { x = y = rw = rh = 0; return false; }
     x = dirtyMinX; y = dirtyMinY;
     rw = dirtyMaxX - dirtyMinX + 1;
     rh = dirtyMaxY - dirtyMinY + 1;
+    return true;
+}
+bool Engine::takeDirtyRect(int& x, int& y, int& rw, int& rh) {
+    if (!peekDirtyRect(x, y, rw, rh)) return false;
     clearDirty();
     return true;
 }
 
+// -------------- escrituras del plano (hash, resumen) --------------
+inline void Engine::writeBack(int x, int y, u8 m) {
+    const int i = idx(x, y);
+    const u8 prev = mBack[i];
+    if (prev == m) return;
+    mBack[i] = m;
+    occBack.set(x, y, m);
+    const std::uint64_t d = zobristDelta(size_t(i), prev, m);
+    hashBack ^= d;
+    if (chunkHashing) chunkBack[size_t((y >> kHashChunkShift) * hcw + (x >> kHashChunkShift))] ^= d;
+    if (summaryOn) matSummary.onWrite(x, y, prev, m);
+    if (emissiveOn) noteEmissive(x, y, prev, m);
+}
+
+inline void Engine::noteFront(int x, int y, int i, u8 prev, u8 m) {
+    const std::uint64_t d = zobristDelta(size_t(i), prev, m);
+    hashFront ^= d;
+    if (chunkHashing) chunkFront[size_t((y >> kHashChunkShift) * hcw + (x >> kHashChunkShift))] ^= d;
+    if (summaryOn) matSummary.onWrite(x, y, prev, m);
+    if (emissiveOn) noteEmissive(x, y, prev, m);
+}
+
+inline void Engine::writeFront(int x, int y, u8 m) {
+    const int i = idx(x, y);
+    const u8 prev = mFront[i];
+    if (prev == m) return;
+    mFront[i] = m;
+    occFront.set(x, y, m);
+    noteFront(x, y, i, prev, m);
+}
+
+void Engine::rehash() {
+    hashFront = 0;
+    if (chunkHashing) chunkFront.assign(size_t(hcw) * size_t(hch), 0);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            const std::uint64_t k = zobristKey(size_t(idx(x, y)), mFront[idx(x, y)]);
+            hashFront ^= k;
+            if (chunkHashing) chunkFront[size_t((y >> kHashChunkShift) * hcw + (x >> kHashChunkShift))] ^= k;
+        }
+}
+
+void Engine::resetOccupancy() {
+    std::array<std::uint8_t, 256> cls{};
+    for (int m = 0; m < 256; ++m) {
+        if (m == (u8)Material::NullCell) continue;
+        const MatProps& mp = matProps(u8(m));
+        if (mp.updateClass == UpdateClass::Active) cls[size_t(m)] |= Occupancy::kActive;
+        if (mp.updateClass == UpdateClass::Reactive) cls[size_t(m)] |= Occupancy::kReactive;
+        if (mp.wakesReactive) cls[size_t(m)] |= Occupancy::kWake;
+    }
+    occFront.reset(mFront.data(), w, h, cls);
+    occBack.reset(mBack.data(), w, h, cls);
+}
+
+void Engine::enableSummary(bool on) {
+    summaryOn = on;
+    if (on) matSummary.reset(mFront.data(), w, h);
+}
+
+// --------------------------- emisivos ---------------------------
+void Engine::trackEmissive(bool on) {
+    emissiveOn = on;
+    if (!on) { emissiveCount.clear(); emissiveTotal = 0; return; }
+    for (int m = 0; m < 256; ++m) emissiveMat[size_t(m)] = matProps(u8(m)).emissive > 1.0f;
+    emissiveMat[(u8)Material::NullCell] = false;
+    resetEmissive();
+}
+
+void Engine::resetEmissive() {
+    const int tw = (w + kSummaryChunk - 1) >> kSummaryShift, th = (h + kSummaryChunk - 1) >> kSummaryShift;
+    emissiveCount.assign(size_t(tw) * size_t(th), 0);
+    emissiveTotal = 0;
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+            if (emissiveMat[mFront[size_t(idx(x, y))]]) {
+                ++emissiveCount[size_t((y >> kSummaryShift) * tw + (x >> kSummaryShift))];
+                ++emissiveTotal;
+            }
+}
+
+// Tramos de teselas con emisivos por fila de teselas; un tramo con el mismo rango de
+// columnas que uno que acaba en la fila anterior lo alarga en vez de abrir otro
+int Engine::emissiveRects(int* xywh, int maxRects) const {
+    if (!emissiveOn || emissiveTotal == 0 || maxRects <= 0) return 0;
+    const int tw = (w + kSummaryChunk - 1) >> kSummaryShift, th = (h + kSummaryChunk - 1) >> kSummaryShift;
+    int n = 0;
+    bool overflow = false;
+    int ux0 = tw, uy0 = th, ux1 = 0, uy1 = 0;   // envolvente, en teselas
+    for (int ty = 0; ty < th; ++ty) {
+        const std::uint16_t* row = emissiveCount.data() + size_t(ty) * size_t(tw);
+        for (int tx = 0; tx < tw;) {
+            if (!row[tx]) { ++tx; continue; }
+            const int a = tx;
+            while (tx < tw && row[tx]) ++tx;
+            ux0 = std::min(ux0, a); ux1 = std::max(ux1, tx);
+            uy0 = std::min(uy0, ty); uy1 = std::max(uy1, ty + 1);
+            if (overflow) continue;
+            int k = 0;
+            while (k < n && !(xywh[4 * k] == a && xywh[4 * k + 2] == tx - a && xywh[4 * k + 1] + xywh[4 * k + 3] == ty)) ++k;
+            if (k < n) { ++xywh[4 * k + 3]; continue; }
+            if (n == maxRects) { overflow = true; continue; }
+            xywh[4 * n] = a; xywh[4 * n + 1] = ty; xywh[4 * n + 2] = tx - a; xywh[4 * n + 3] = 1;
+            ++n;
+        }
+    }
+    if (overflow) { n = 1; xywh[0] = ux0; xywh[1] = uy0; xywh[2] = ux1 - ux0; xywh[3] = uy1 - uy0; }
+    // De teselas a celdas, recortado a la rejilla
+    for (int k = 0; k < n; ++k) {
+        int* r = xywh + 4 * k;
+        const int x0 = r[0] << kSummaryShift, y0 = r[1] << kSummaryShift;
+        r[2] = std::min(w, (r[0] + r[2]) << kSummaryShift) - x0;
+        r[3] = std::min(h, (r[1] + r[3]) << kSummaryShift) - y0;
+        r[0] = x0; r[1] = y0;
+    }
+    return n;
+}
+
+void Engine::enableChunkHashes(bool on) {
+    chunkHashing = on;
+    if (!on) { chunkFront.clear(); chunkBack.clear(); return; }
+    rehash();
+    chunkBack = chunkFront;
+}
+
+// ------------------------- LOD temporal -------------------------
+void Engine::enableLod(bool on) {
+    lodOn = on && simMode == SimMode::Scan;
+    if (lodOn) lodSched.resize(w, h);
+}
+
+// ------------------------ chunks tocados ------------------------
+void Engine::trackTouched(bool on) {
+    touchOn = on;
+    touchedFlag.assign(on ? size_t(touchChunksX()) * size_t(touchChunksY()) : 0, 0);
+    touchedList.clear();
+    touchedList.reserve(touchedFlag.size());   // un chunk entra una vez: nunca crece
+}
+
+void Engine::clearTouched() {
+    for (std::uint32_t c : touchedList) touchedFlag[c] = 0;
+    touchedList.clear();
+}
+
+void Engine::touchRect(int x0, int y0, int x1, int y1) {
+    for (int cy = y0 >> touchShift; cy <= (y1 >> touchShift); ++cy)
+        for (int cx = x0 >> touchShift; cx <= (x1 >> touchShift); ++cx)
+            touch(cx << touchShift, cy << touchShift);
+}
+
+void Engine::readChunk(int cx, int cy, Cell* out) const {
+    const int x0 = cx << touchShift, y0 = cy << touchShift;
+    const int x1 = std::min(w, x0 + touchChunk), y1 = std::min(h, y0 + touchChunk);
+    for (int y = y0; y < y1; ++y)
+        forEachRun(y, x0, x1, [&](int i, int x, int n) {
+            std::copy(front.begin() + i, front.begin() + (i + n), out + (y - y0) * touchChunk + (x - x0));
+        });
+}
+
+void Engine::writeChunk(int cx, int cy, const Cell* in) {
+    const int x0 = cx << touchShift, y0 = cy << touchShift;
+    const int x1 = std::min(w, x0 + touchChunk), y1 = std::min(h, y0 + touchChunk);
+    u8 row[touchChunk];
+    for (int y = y0; y < y1; ++y) {
+        const Cell* src = in + (y - y0) * touchChunk;
+        for (int x = x0; x < x1; ++x) row[x - x0] = src[x - x0].m;
+        noteSpan(y, x0, x1, row, 0);
+        std::memcpy(mFront.data() + idx(x0, y), row, size_t(x1 - x0));
+        forEachRun(y, x0, x1, [&](int i, int x, int n) {
+            std::copy(src + (x - x0), src + (x - x0 + n), front.begin() + i);
+        });
+    }
+    markDirtyRect(x0, y0, x1 - 1, y1 - 1);
+}
+
 // ---------------------------- sim -----------------------------
 void Engine::update(float dt) {
     accumulator += dt;
+    int steps = 0;
     while (accumulator >= fixedStep && (!paused || stepOnce)) {
-        // back = front; y SoA
-        back = front;
-        mBack = mFront;
-
-        step();
-
-        swapBuffers();
+        if (maxStepsPerUpdate > 0 && steps == maxStepsPerUpdate) { accumulator = 0; break; }
+        tick();
+        if (observer) observer->ticked(*this);
+        ++steps;
         accumulator -= fixedStep;
-        parity ^= 1;
 
         if (paused) { stepOnce = false; break; }
     }
@@ -77,40 +309,89 @@ void Engine::update(float dt) {
     if (paused) accumulator = 0;
 }
 
+void Engine::tick() {
+    if (simMode == SimMode::Margolus) {
+        if (probe) probe->begin(TickPhase::Step);
+        stepMargolus();
+        if (probe) probe->end(TickPhase::Step);
+        parity ^= 1;
+        ++tickCount;
+        return;
+    }
+
+    if (probe) probe->begin(TickPhase::Sync);
+    syncBack();
+    if (probe) { probe->end(TickPhase::Sync); probe->begin(TickPhase::Step); }
+    step();
+    if (probe) probe->end(TickPhase::Step);
+
+    swapBuffers();
+    parity ^= 1;
+    ++tickCount;
+}
+
+// back = front, pero solo en las filas/tramos marcados desde la ultima copia: fuera de
+// ellos los dos buffers ya coinciden (lo que escribio step() y cualquier edicion en front
+// pasa por markDirty/markDirtyRect/setVelocity)
+void Engine::syncBack() {
+    for (int y = 0; y < h; ++y) {
+        const int x0 = syncLo[size_t(y)], x1 = syncHi[size_t(y)];
+        if (x1 < x0) continue;
+        forEachRun(y, x0, x1 + 1, [&](int i, int, int n) {
+            std::copy(front.begin() + i, front.begin() + (i + n), back.begin() + i);
+        });
+        const int i = idx(x0, y);
+        std::memcpy(mBack.data() + i, mFront.data() + i, size_t(x1 - x0 + 1));
+        occBack.copyRow(occFront, y, x0, x1);
+        syncLo[size_t(y)] = w; syncHi[size_t(y)] = -1;
+    }
+    hashBack = hashFront;
+    if (chunkHashing) chunkBack = chunkFront;
+}
+
 bool Engine::tryMove(int sx, int sy, int dx, int dy, const Cell& c) {
     int nx = sx + dx, ny = sy + dy;
-    if (!inRange(nx, ny)) return false;
-    int si = idx(sx, sy), ni = idx(nx, ny);
+    int si = cellIdx(sx, sy), ni = cellIdx(nx, ny);
 
+    // Ocupado o anillo (NullCell)
     if (back[ni].m != (u8)Material::Empty) return false;
 
     back[ni] = c;
-    if (back[si].m == front[si].m) back[si].m = (u8)Material::Empty;
+    writeBack(nx, ny, c.m);
+    // Si otra celda ya ocupo el origen este tick, se queda (y el plano con ella)
+    if (back[si].m == front[si].m) {
+        back[si].m = (u8)Material::Empty;
+        writeBack(sx, sy, (u8)Material::Empty);
+    }
 
-    // SoA + dirty
-    mBack[ni] = c.m;
-    mBack[si] = (u8)Material::Empty;
     markDirty(sx, sy);
     markDirty(nx, ny);
     return true;
 }
 
+int Engine::castRay(int sx, int sy, int dx, int dy, int maxSteps) const {
+    int n = 0;
+    while (n < maxSteps && nbVacant(sx + dx * (n + 1), sy + dy * (n + 1))) ++n;
+    return n;
+}
+
 bool Engine::trySwap(int sx, int sy, int dx, int dy, const Cell& c) {
     int nx = sx + dx, ny = sy + dy;
-    if (!inRange(nx, ny, w, h)) return false;
-
-    int si = idx(sx, sy);
-    int ni = idx(nx, ny);
+    int si = cellIdx(sx, sy);
+    int ni = cellIdx(nx, ny);
     if (si == ni) return false;
 
-    const Cell& dst = front[ni];
+    // Si el destino ya se movio este tick, intercambiar duplicaria material
+    if (back[ni].m != front[ni].m) return false;
+    const Cell dst = back[ni];
+    if (dst.m == (u8)Material::NullCell) return false;     // anillo
 
     back[ni] = c;
     back[si] = dst;
 
     // SoA + dirty
-    mBack[ni] = c.m;
-    mBack[si] = dst.m;
+    writeBack(nx, ny, c.m);
+    writeBack(sx, sy, dst.m);
     markDirty(sx, sy);
     markDirty(nx, ny);
     return true;
@@ -118,51 +399,280 @@ bool Engine::trySwap(int sx, int sy, int dx, int dy, const Cell& c) {
 
 void Engine::setCell(int x, int y, u8 m) {
     if (!inRange(x, y)) return;
-    int i = idx(x, y);
+    int i = cellIdx(x, y);
     u8 prev = back[i].m;
     if (prev == m) return;
 
     back[i].m = m;
-    mBack[i] = m;
+    writeBack(x, y, m);
     markDirty(x, y);
 
-    if (m == (u8)Material::Fire && prev != (u8)Material::Fire) {
-        audioEvents.push_back({ AudioEvent::Type::Ignite, x, y });
+    if (audioEnabled && m == (u8)Material::Fire && prev != (u8)Material::Fire) {
+        pushAudio(AudioEvent::Type::Ignite, x, y);
     }
 }
 
+void Engine::setVelocity(int x, int y, int vx, int vy) {
+    if (!inRange(x, y)) return;
+    int i = cellIdx(x, y);
+    if (back[i].m != front[i].m) return; // otra celda ya ocupo el hueco
+    back[i].vx = vx; back[i].vy = vy;
+    if (touchOn) touch(x, y);
+    markSync(y, x, x);
+}
+
+// Mismo orden que un barrido celda a celda (abajo->arriba, sentido alterno por fila),
+// pero solo sobre los bits 'active' de front, mas los 'reactive' que tienen un vecino
+// capaz de hacerles reaccionar: Empty, estaticos inertes y la madera lejos del fuego no
+// cuestan nada, y las filas sin ninguno de los dos se saltan por su contador.
+// front no se escribe durante step(), asi que las filas de occFront son estables.
+//
+// Con LOD, los bits activos se cruzan con la mascara de chunks que tocan este tick y
+// cada kernel ve en tickScale() el periodo de su chunk. Un material con tickRate > 1
+// solo corre en 1 de cada tickRate ticks (o pasadas de su chunk) y escala igual.
 void Engine::step() {
+    const int words = occFront.rowWords();
+    if (lodOn) lodSched.plan(tickCount);
+    auto run = [&](int x, int y) {
+        const Cell c = front[cellIdx(x, y)];
+        const MatProps& mp = matProps(c.m);
+        if (!mp.update) return;
+        int scale = 1;
+        if (lodOn || mp.tickRate > 1) {
+            std::uint64_t k = tickCount;
+            if (lodOn) { scale = lodSched.period(x, y); k = lodSched.runIndex(x, y, tickCount); }
+            if (mp.tickRate > scale) {
+                // Fase escalonada por franjas de 32 filas para repartir la carga
+                const int q = mp.tickRate / scale;
+                if ((k + std::uint64_t(y >> LodScheduler::kShift)) & std::uint64_t(q - 1)) return;
+                scale = mp.tickRate;
+            }
+        }
+        curScale = scale;
+        mp.update(*this, x, y, c);
+    };
     for (int y = h - 1; y >= 0; --y) {
-        bool l2r = ((y ^ parity) & 1);
-        int x0 = l2r ? 0 : (w - 1);
-        int x1 = l2r ? w : -1;
-        int s = l2r ? 1 : -1;
-
-        for (int x = x0; x != x1; x += s) {
-            const Cell c = front[idx(x, y)];
-            if (c.m == (u8)Material::Empty) continue;
-            const MatProps& mp = matProps(c.m);
-            if (mp.update) mp.update(*this, x, y, c);
+        const bool woken = occFront.rowWoken(y);
+        if (!woken && !occFront.activeCount(y)) continue;
+        const std::uint64_t* row = occFront.activeRow(y);
+        const std::uint64_t* react = occFront.reactiveRow(y);
+        const std::uint64_t* lodRow = lodOn ? lodSched.runRow(y) : nullptr;
+        auto bits = [&](int wi) {
+            std::uint64_t b = row[wi];
+            if (woken && react[wi]) b |= react[wi] & occFront.wakeHalo(y, wi);
+            return lodRow ? b & lodRow[wi] : b;
+        };
+        if ((y ^ parity) & 1) {
+            for (int wi = 0; wi < words; ++wi)
+                for (std::uint64_t b = bits(wi); b; b &= b - 1)
+                    run((wi << 6) + lowestBit(b), y);
+        }
+        else {
+            for (int wi = words - 1; wi >= 0; --wi)
+                for (std::uint64_t b = bits(wi); b;) {
+                    const int k = highestBit(b);
+                    b &= ~(std::uint64_t(1) << k);
+                    run((wi << 6) + k, y);
+                }
+        }
+    }
+    curScale = 1;
+}
+
+// Bloques 2x2 con origen en (-parity, -parity) + 2k: la particion alterna cada tick.
+// Los bloques no se solapan, asi que se resuelven en sitio sobre front y en cualquier
+// orden; el azar de cada uno sale de su posicion y de una sal por tick, no del RNG
+// compartido, para que el orden no cambie el resultado.
+void Engine::stepMargolus() {
+    const std::uint32_t salt = rand32();
+    for (int by = -parity; by < h; by += 2) {
+        for (int bx = -parity; bx < w; bx += 2) {
+            const int xs[4] = { bx, bx + 1, bx, bx + 1 };
+            const int ys[4] = { by, by, by + 1, by + 1 };
+            // Los bloques del borde asoman al anillo, que ya es NullCell. blockRule solo
+            // mira dentro del bloque, asi que un Reactive sin 'wake' en el bloque no hace nada
+            u8 mq[4];
+            bool active = false, reactive = false, wake = false;
+            for (int k = 0; k < 4; ++k) {
+                mq[k] = nbM(xs[k], ys[k]);
+                if (mq[k] == (u8)Material::NullCell) continue;
+                const MatProps& mp = matProps(mq[k]);
+                active |= mp.updateClass == UpdateClass::Active;
+                reactive |= mp.updateClass == UpdateClass::Reactive;
+                wake |= mp.wakesReactive;
+            }
+            if (!active && !(reactive && wake)) continue;   // vacio o solo materiales inertes
+
+            Cell q[4];
+            for (int k = 0; k < 4; ++k) q[k] = front[cellIdx(xs[k], ys[k])];
+            std::uint32_t r = std::uint32_t(bx * 374761393u) ^ std::uint32_t(by * 668265263u) ^ salt;
+            r ^= r >> 13; r *= 1274126177u; r ^= r >> 16;
+
+            Cell before[4] = { q[0], q[1], q[2], q[3] };
+            if (!blockRule(q, r)) continue;
+            for (int k = 0; k < 4; ++k) {
+                if (before[k].m == (u8)Material::NullCell) continue;
+                const Cell& c = q[k];
+                const Cell& p = before[k];
+                if (c.m == p.m && c.vx == p.vx && c.vy == p.vy) continue;
+                front[cellIdx(xs[k], ys[k])] = c;
+                writeFront(xs[k], ys[k], c.m);
+                markDirty(xs[k], ys[k]);
+                if (audioEnabled && c.m == (u8)Material::Fire && p.m != (u8)Material::Fire)
+                    pushAudio(AudioEvent::Type::Ignite, xs[k], ys[k]);
+            }
         }
     }
 }
 
 // --------------------------- pintar ---------------------------
 void Engine::paint(int cx, int cy, Material m, int r) {
-    int r2 = r * r;
-    int xmin = std::max(0, cx - r), xmax = std::min(w - 1, cx + r);
-    int ymin = std::max(0, cy - r), ymax = std::min(h - 1, cy + r);
-
-    for (int y = ymin; y <= ymax; ++y)
-        for (int x = xmin; x <= xmax; ++x) {
-            int dx = x - cx, dy = y - cy;
-            if (dx * dx + dy * dy <= r2) {
-                int i = idx(x, y);
-                front[i].m = (u8)m;   // efecto inmediato
-                mFront[i] = (u8)m;    // SoA inmediato
-                markDirty(x, y);
-            }
+    fillCircle(cx, cy, r, m);
+    if (audioEnabled) pushAudio(AudioEvent::Type::Paint, cx, cy);
+}
+
+// ------------------------ ediciones en bloque ------------------------
+// Los spans escriben front (efecto inmediato, sin velocidad heredada). El hash y el
+// resumen solo miran las celdas que cambian; el plano y las celdas van con memset/fill.
+// Bookkeeping de un span en front: hash (por tramos de chunk) y resumen, solo en las
+// celdas que cambian. 'src' es el valor nuevo de cada celda, o null para 'm' en todas
+void Engine::noteSpan(int y, int x0, int x1, const u8* src, u8 m) {
+    const int row = idx(0, y);
+    const u8* p = mFront.data() + row;
+    for (int a = x0; a < x1;) {
+        const int b = std::min(x1, ((a >> kHashChunkShift) + 1) << kHashChunkShift);
+        std::uint64_t d = 0;
+        for (int x = a; x < b; ++x) {
+            const u8 v = src ? src[x - x0] : m;
+            if (p[x] != v) d ^= zobristDelta(size_t(row + x), p[x], v);
         }
-    markDirtyRect(xmin, ymin, xmax, ymax);
-    audioEvents.push_back({ AudioEvent::Type::Paint, cx, cy });
+        hashFront ^= d;
+        if (chunkHashing) chunkFront[size_t((y >> kHashChunkShift) * hcw + (a >> kHashChunkShift))] ^= d;
+        a = b;
+    }
+    if (summaryOn || emissiveOn)
+        for (int x = x0; x < x1; ++x) {
+            const u8 v = src ? src[x - x0] : m;
+            if (p[x] == v) continue;
+            if (summaryOn) matSummary.onWrite(x, y, p[x], v);
+            if (emissiveOn) noteEmissive(x, y, p[x], v);
+        }
+    occFront.span(y, x0, x1, src, m);
+}
+
+void Engine::fillSpan(int y, int x0, int x1, u8 m) {
+    noteSpan(y, x0, x1, nullptr, m);
+    const int row = idx(0, y);
+    std::memset(mFront.data() + row + x0, m, size_t(x1 - x0));
+    forEachRun(y, x0, x1, [&](int i, int, int n) { std::fill(front.begin() + i, front.begin() + (i + n), Cell{ m }); });
+    markDirtyRect(x0, y, x1 - 1, y);
+}
+
+void Engine::copySpan(int y, int x0, int x1, const u8* src) {
+    noteSpan(y, x0, x1, src, 0);
+    const int row = idx(0, y);
+    std::memcpy(mFront.data() + row + x0, src, size_t(x1 - x0));
+    forEachRun(y, x0, x1, [&](int i, int x, int n) {
+        for (int k = 0; k < n; ++k) front[size_t(i + k)] = Cell{ src[x - x0 + k] };
+    });
+    markDirtyRect(x0, y, x1 - 1, y);
+}
+
+void Engine::fillRect(int x, int y, int rw, int rh, Material m) {
+    const int x0 = std::max(0, x), x1 = std::min(w, x + rw);
+    const int y0 = std::max(0, y), y1 = std::min(h, y + rh);
+    if (x0 >= x1) return;
+    for (int yy = y0; yy < y1; ++yy) fillSpan(yy, x0, x1, (u8)m);
+}
+
+void Engine::fillCircle(int cx, int cy, int r, Material m) {
+    if (r < 0) return;
+    const int r2 = r * r;
+    const int ymin = std::max(0, cy - r), ymax = std::min(h - 1, cy + r);
+    for (int y = ymin; y <= ymax; ++y) {
+        // Mitad del span: mayor dx con dx^2 + dy^2 <= r^2
+        const int dy = y - cy;
+        int half = (int)std::sqrt(double(r2 - dy * dy));
+        while (half * half > r2 - dy * dy) --half;
+        while ((half + 1) * (half + 1) <= r2 - dy * dy) ++half;
+        const int x0 = std::max(0, cx - half), x1 = std::min(w, cx + half + 1);
+        if (x0 < x1) fillSpan(y, x0, x1, (u8)m);
+    }
+}
+
+void Engine::fillPolygon(const int* xy, int n, Material m) {
+    if (n < 3) return;
+    int ymin = xy[1], ymax = xy[1];
+    for (int k = 1; k < n; ++k) { ymin = std::min(ymin, xy[2 * k + 1]); ymax = std::max(ymax, xy[2 * k + 1]); }
+    ymin = std::max(0, ymin); ymax = std::min(h - 1, ymax);
+
+    // Scanline por centros de celda: cortes de cada arista con y + 0.5, rellenar entre pares
+    std::vector<float> cuts;
+    cuts.reserve(size_t(n));
+    for (int y = ymin; y <= ymax; ++y) {
+        const float sy = float(y) + 0.5f;
+        cuts.clear();
+        for (int k = 0; k < n; ++k) {
+            const float ax = float(xy[2 * k]), ay = float(xy[2 * k + 1]);
+            const int j = (k + 1) % n;
+            const float bx = float(xy[2 * j]), by = float(xy[2 * j + 1]);
+            if ((ay <= sy) != (by <= sy)) cuts.push_back(ax + (sy - ay) * (bx - ax) / (by - ay));
+        }
+        std::sort(cuts.begin(), cuts.end());
+        for (size_t k = 0; k + 1 < cuts.size(); k += 2) {
+            // Celdas cuyo centro x + 0.5 cae en [cut0, cut1)
+            const int x0 = std::max(0, (int)std::ceil(cuts[k] - 0.5f));
+            const int x1 = std::min(w, (int)std::ceil(cuts[k + 1] - 0.5f));
+            if (x0 < x1) fillSpan(y, x0, x1, (u8)m);
+        }
+    }
+}
+
+void Engine::stamp(int x, int y, int sw, int sh, const std::uint8_t* src, std::uint8_t transparent) {
+    const int x0 = std::max(0, x), x1 = std::min(w, x + sw);
+    const int y0 = std::max(0, y), y1 = std::min(h, y + sh);
+    if (x0 >= x1) return;
+    for (int yy = y0; yy < y1; ++yy) {
+        const u8* row = src + size_t(yy - y) * size_t(sw) + size_t(x0 - x);
+        // Rachas opacas: cada una es un span
+        int a = x0;
+        while (a < x1) {
+            while (a < x1 && row[a - x0] == transparent) ++a;
+            int b = a;
+            while (b < x1 && row[b - x0] != transparent) ++b;
+            if (a < b) copySpan(yy, a, b, row + (a - x0));
+            a = b;
+        }
+    }
+}
+
+void Engine::copyRegion(int x, int y, int rw, int rh, std::vector<std::uint8_t>& out) const {
+    out.assign(size_t(std::max(0, rw)) * size_t(std::max(0, rh)), (u8)Material::NullCell);
+    const int x0 = std::max(0, x), x1 = std::min(w, x + rw);
+    const int y0 = std::max(0, y), y1 = std::min(h, y + rh);
+    if (x0 >= x1) return;
+    for (int yy = y0; yy < y1; ++yy)
+        std::memcpy(out.data() + size_t(yy - y) * size_t(rw) + size_t(x0 - x), mFront.data() + idx(x0, yy), size_t(x1 - x0));
+}
+
+void Engine::copyFrom(const Engine& src, int sx, int sy, int rw, int rh, int dx, int dy) {
+    // Via buffer: cubre el solape dentro del mismo mundo y las celdas fuera del origen
+    // (NullCell) quedan como transparentes
+    std::vector<std::uint8_t> tmp;
+    src.copyRegion(sx, sy, rw, rh, tmp);
+    stamp(dx, dy, rw, rh, tmp.data());
+}
+
+void Engine::setPlane(const std::uint8_t* src) {
+    const size_t n = size_t(w) * size_t(h);
+    std::copy(src, src + n, mFront.begin());
+    for (int y = 0; y < h; ++y)
+        forEachRun(y, 0, w, [&](int i, int x, int k) {
+            for (int j = 0; j < k; ++j) front[size_t(i + j)] = Cell{ src[size_t(idx(x + j, y))] };
+        });
+    rehash();
+    resetOccupancy();
+    if (summaryOn) matSummary.reset(mFront.data(), w, h);
+    if (emissiveOn) resetEmissive();
+    markDirtyRect(0, 0, w - 1, h - 1);
 }
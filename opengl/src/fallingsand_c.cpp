@@ -0,0 +1,155 @@
+#include "fallingsand_c.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "engine.h"
+#include "material.h"
+
+struct fs_world {
+    Engine engine;
+    fs_stats stats{};
+    // Union de los dirty-rects consumidos por fs_step, hasta fs_take_dirty_rect
+    int dMinX, dMinY, dMaxX, dMaxY;
+
+    fs_world(int w, int h, std::uint32_t seed) : engine(w, h, seed) {
+        engine.audioEnabled = false;
+        resetDirty();
+    }
+    void resetDirty() { dMinX = engine.width(); dMinY = engine.height(); dMaxX = -1; dMaxY = -1; }
+    void addDirty(int x, int y, int rw, int rh) {
+        dMinX = std::min(dMinX, x); dMinY = std::min(dMinY, y);
+        dMaxX = std::max(dMaxX, x + rw - 1); dMaxY = std::max(dMaxY, y + rh - 1);
+    }
+    void step(int ticks) {
+        auto t0 = std::chrono::steady_clock::now();
+        int x, y, rw, rh;
+        // El rect de la pintura previa tambien entra en la union
+        if (engine.takeDirtyRect(x, y, rw, rh)) addDirty(x, y, rw, rh);
+        for (int t = 0; t < ticks; ++t) {
+            engine.tick();
+            if (engine.takeDirtyRect(x, y, rw, rh)) {
+                stats.dirty_cells += std::uint64_t(rw) * std::uint64_t(rh);
+                addDirty(x, y, rw, rh);
+            }
+            else ++stats.quiet_ticks;
+        }
+        stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        stats.ticks = engine.ticks();
+    }
+};
+
+// Un id pintable: dentro de la tabla cargada y nunca NullCell (el anillo fantasma)
+static bool validMaterial(int m) {
+    if (m < 0 || m >= 255) return false;
+    ensureMaterials();
+    return m == (int)Material::Empty || !matProps(u8(m)).name.empty();
+}
+
+extern "C" {
+
+int fs_api_version(void) { return FS_API_VERSION; }
+
+// Ninguna excepcion (bad_alloc de los vectores del motor) puede cruzar la frontera C:
+// las funciones que reservan memoria la convierten en su valor de error
+
+int fs_load_materials(const char* path) {
+    try { return path && loadMaterialFile(path) ? 1 : 0; }
+    catch (...) { return 0; }
+}
+
+int fs_material_id(const char* name) {
+    if (!name) return -1;
+    try {
+        ensureMaterials();
+        const u8 id = findMaterial(name);
+        return id == (u8)Material::NullCell ? -1 : int(id);
+    }
+    catch (...) { return -1; }
+}
+
+fs_world* fs_create(int width, int height, uint32_t seed) {
+    if (width <= 0 || height <= 0) return nullptr;
+    try { return new fs_world(width, height, seed); }
+    catch (...) { return nullptr; }
+}
+
+void fs_destroy(fs_world* w) { delete w; }
+
+int fs_width(const fs_world* w) { return w ? w->engine.width() : 0; }
+int fs_height(const fs_world* w) { return w ? w->engine.height() : 0; }
+uint64_t fs_ticks(const fs_world* w) { return w ? w->engine.ticks() : 0; }
+
+void fs_step(fs_world* w, int ticks) {
+    if (!w) return;
+    try { w->step(ticks); }
+    catch (...) {}
+}
+
+const uint8_t* fs_plane(const fs_world* w) { return w ? w->engine.planeM() : nullptr; }
+
+int fs_get_plane(const fs_world* w, uint8_t* out, size_t size) {
+    if (!w) return 0;
+    const size_t n = size_t(w->engine.width()) * size_t(w->engine.height());
+    if (!out || size < n) return 0;
+    std::memcpy(out, w->engine.planeM(), n);
+    return 1;
+}
+
+int fs_set_plane(fs_world* w, const uint8_t* src, size_t size) {
+    if (!w) return 0;
+    const size_t n = size_t(w->engine.width()) * size_t(w->engine.height());
+    if (!src || size != n) return 0;
+    try {
+        for (size_t i = 0; i < n; ++i) if (!validMaterial(src[i])) return 0;
+        w->engine.setPlane(src);
+        return 1;
+    }
+    catch (...) { return 0; }
+}
+
+void fs_paint(fs_world* w, int cx, int cy, int material, int radius) {
+    try {
+        if (!w || !validMaterial(material)) return;
+        w->engine.paint(cx, cy, Material(u8(material)), radius);
+    }
+    catch (...) {}
+}
+
+int fs_take_dirty_rect(fs_world* w, int* x, int* y, int* rw, int* rh) {
+    if (!w) return 0;
+    int ex, ey, ew, eh;
+    if (w->engine.takeDirtyRect(ex, ey, ew, eh)) w->addDirty(ex, ey, ew, eh);
+    const bool any = w->dMaxX >= w->dMinX && w->dMaxY >= w->dMinY;
+    if (x) *x = any ? w->dMinX : 0;
+    if (y) *y = any ? w->dMinY : 0;
+    if (rw) *rw = any ? w->dMaxX - w->dMinX + 1 : 0;
+    if (rh) *rh = any ? w->dMaxY - w->dMinY + 1 : 0;
+    w->resetDirty();
+    return any ? 1 : 0;
+}
+
+void fs_get_stats(const fs_world* w, fs_stats* out) {
+    if (!w || !out) return;
+    *out = w->stats;
+    std::memset(out->counts, 0, sizeof(out->counts));
+    const std::uint8_t* p = w->engine.planeM();
+    const size_t n = size_t(w->engine.width()) * size_t(w->engine.height());
+    for (size_t i = 0; i < n; ++i) ++out->counts[p[i]];
+}
+
+uint64_t fs_hash(const fs_world* w) { return w ? w->engine.stateHash() : 0; }
+
+void fs_enable_chunk_hashes(fs_world* w, int on) {
+    if (!w) return;
+    try { w->engine.enableChunkHashes(on != 0); }
+    catch (...) {}
+}
+
+uint64_t fs_chunk_hash(const fs_world* w, int cx, int cy) {
+    if (!w) return 0;
+    const Engine& e = w->engine;
+    if (cx < 0 || cy < 0 || cx >= e.hashChunksX() || cy >= e.hashChunksY()) return 0;
+    return e.chunkHash(cx, cy);
+}
+
+} // extern "C"
@@ -0,0 +1,43 @@
+#include "governor.h"
+#include <cstdio>
+
+// Orden de degradacion: lo que menos se nota primero
+static const FrameGovernor::Level kLevelTable[FrameGovernor::kLevels] = {
+    //Nombre            //Bloom //Div   //Pasadas   //Efectos   //Sim
+    { "completo",       { true,  1,      6,          true  },    1.00f },
+    { "bloom 1/2",      { true,  2,      4,          true  },    1.00f },
+    { "bloom 1/4",      { true,  4,      2,          true  },    1.00f },
+    { "sin bloom",      { false, 4,      0,          true  },    1.00f },
+    { "grid plano",     { false, 4,      0,          false },    1.00f },
+    { "sim 75%",        { false, 4,      0,          false },    0.75f },
+    { "sim 50%",        { false, 4,      0,          false },    0.50f },
+};
+
+const FrameGovernor::Level& FrameGovernor::level(int i) { return kLevelTable[i]; }
+
+bool FrameGovernor::frame(double frameMs, double workMs) {
+    ++frames;
+    // Media exponencial: un pico aislado (carga de shader, GC del driver) no cuenta
+    const double a = 0.1;
+    avgFrame = frames == 1 ? frameMs : avgFrame + a * (frameMs - avgFrame);
+    avgWork = frames == 1 ? workMs : avgWork + a * (workMs - avgWork);
+    if (!enabled) return false;
+    if (hold > 0) { --hold; return false; }
+
+    over = avgFrame > target * 1.15 ? over + 1 : 0;
+    under = avgWork < target * 0.6 ? under + 1 : 0;
+
+    if (over >= degradeAfter && lvl + 1 < kLevels) { set(lvl + 1, "frame"); return true; }
+    if (under >= restoreAfter && lvl > 0) { set(lvl - 1, "trabajo"); return true; }
+    return false;
+}
+
+void FrameGovernor::set(int to, const char* why) {
+    if (log)
+        std::fprintf(stderr, "governor: nivel %d (%s) -> %d (%s), %s %.2f ms, objetivo %.2f ms\n",
+            lvl, level(lvl).name, to, level(to).name, why,
+            to > lvl ? avgFrame : avgWork, target);
+    lvl = to;
+    over = under = 0;
+    hold = cooldown;
+}
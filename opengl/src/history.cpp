@@ -0,0 +1,124 @@
+#include "history.h"
+#include <cstring>
+
+void History::attach(Engine& e) {
+    engine = &e;
+    e.trackTouched(true);
+    const int n = e.touchChunksX() * e.touchChunksY();
+    base.assign(size_t(n), nullptr);
+    for (int c = 0; c < n; ++c) {
+        auto ch = std::make_shared<Chunk>();
+        e.readChunk(c % e.touchChunksX(), c / e.touchChunksX(), ch->cells);
+        base[size_t(c)] = std::move(ch);
+    }
+    baseState = e.simState();
+    baseLod = snapshotLod();
+    jumped = false;
+    steps.clear();
+    cursor = 0;
+    used = 0;
+}
+
+void History::detach() {
+    if (engine) engine->trackTouched(false);
+    engine = nullptr;
+    base.clear();
+    baseLod.reset();
+    steps.clear();
+    cursor = 0;
+    used = 0;
+}
+
+void History::checkpoint() {
+    if (!engine) return;
+    const std::vector<std::uint32_t>& touched = engine->touchedChunks();
+    if (touched.empty()) return;
+
+    steps.resize(cursor); // una rama nueva invalida el redo
+    jumped = false;
+    Step s;
+    s.before = baseState;
+    s.after = engine->simState();
+    s.lodBefore = baseLod;
+    s.lodAfter = snapshotLod();
+    if (s.lodAfter) s.bytes += s.lodAfter->hit.size() * (sizeof(std::uint8_t) + sizeof(std::uint16_t));
+    const int cw = engine->touchChunksX();
+    for (std::uint32_t c : touched) {
+        auto ch = std::make_shared<Chunk>();
+        engine->readChunk(int(c) % cw, int(c) / cw, ch->cells);
+        // Tocado pero igual (p.ej. ida y vuelta): se sigue compartiendo el anterior
+        if (std::memcmp(ch->cells, base[c]->cells, sizeof(ch->cells)) == 0) continue;
+        s.changes.push_back({ c, base[c], ch });
+        base[c] = std::move(ch);
+        s.bytes += sizeof(Chunk);
+    }
+    engine->clearTouched();
+    baseState = s.after;
+    baseLod = s.lodAfter;
+    used += s.bytes;
+    steps.push_back(std::move(s));
+    ++cursor;
+    trim();
+}
+
+History::LodPtr History::snapshotLod() const {
+    const LodScheduler* lod = engine->lod();
+    if (!lod) return nullptr;
+    auto st = std::make_shared<LodScheduler::State>();
+    lod->save(*st);
+    return st;
+}
+
+// Tras escribir los chunks: writeChunk marca sus chunks como activos en el LOD
+void History::restore(const Engine::SimState& st, const LodPtr& lodState) {
+    baseState = st;
+    baseLod = lodState;
+    engine->setSimState(st);
+    if (LodScheduler* lod = engine->lod())
+        if (lodState) lod->restore(*lodState);
+    engine->clearTouched(); // el mundo coincide de nuevo con 'base'
+    jumped = true;
+}
+
+// Vuelve a 'base' los chunks que la simulacion toco desde el ultimo salto
+void History::discardTouched() {
+    const int cw = engine->touchChunksX();
+    for (std::uint32_t c : engine->touchedChunks())
+        engine->writeChunk(int(c) % cw, int(c) / cw, base[c]->cells);
+}
+
+void History::apply(const Step& s, bool forward) {
+    discardTouched();
+    const int cw = engine->touchChunksX();
+    for (const Change& c : s.changes) {
+        const ChunkPtr& p = forward ? c.after : c.before;
+        engine->writeChunk(int(c.chunk) % cw, int(c.chunk) / cw, p->cells);
+        base[c.chunk] = p;
+    }
+    if (forward) restore(s.after, s.lodAfter);
+    else restore(s.before, s.lodBefore);
+}
+
+bool History::undo() {
+    if (!engine) return false;
+    if (!jumped) checkpoint();
+    if (cursor == 0) return false;
+    apply(steps[--cursor], false);
+    return true;
+}
+
+bool History::redo() {
+    if (!engine || cursor >= steps.size()) return false;
+    apply(steps[cursor++], true);
+    return true;
+}
+
+void History::trim() {
+    // Los 'before' del paso mas viejo solo los referencia ese paso: quitarlo los libera.
+    // El ultimo paso se conserva aunque no quepa, para poder deshacer al menos uno
+    size_t drop = 0;
+    while (used > budget && drop + 1 < cursor) used -= steps[drop++].bytes;
+    if (drop == 0) return;
+    steps.erase(steps.begin(), steps.begin() + long(drop));
+    cursor -= drop;
+}
@@ -0,0 +1,55 @@
+#include "lod.h"
+#include <algorithm>
+
+void LodScheduler::resize(int gw, int gh) {
+    w = gw; h = gh;
+    cw = (w + kChunk - 1) >> kShift;
+    ch = (h + kChunk - 1) >> kShift;
+    words = (w + 63) >> 6;
+    const std::size_t n = std::size_t(cw) * std::size_t(ch);
+    // Todo empieza activo: el primer plan() no puede saber que esta quieto
+    hit.assign(n, 1);
+    per.assign(n, 1);
+    quiet.assign(n, 0);
+    mask.assign(std::size_t(ch) * std::size_t(words), 0);
+    setView(0, 0, w, h);
+}
+
+void LodScheduler::setView(int x0, int y0, int x1, int y1) {
+    // Un chunk de margen: lo que entra en pantalla ya viene al ritmo completo
+    vx0 = std::max(0, (x0 >> kShift) - 1);
+    vy0 = std::max(0, (y0 >> kShift) - 1);
+    vx1 = std::min(cw, ((x1 + kChunk - 1) >> kShift) + 1);
+    vy1 = std::min(ch, ((y1 + kChunk - 1) >> kShift) + 1);
+}
+
+void LodScheduler::noteRect(int x0, int y0, int x1, int y1) {
+    for (int cy = y0 >> kShift; cy <= (y1 >> kShift); ++cy)
+        for (int cx = x0 >> kShift; cx <= (x1 >> kShift); ++cx)
+            hit[std::size_t(cy * cw + cx)] = 1;
+}
+
+void LodScheduler::plan(std::uint64_t tick) {
+    std::fill(mask.begin(), mask.end(), 0);
+    ran = 0;
+    for (int cy = 0; cy < ch; ++cy) {
+        std::uint64_t* row = mask.data() + std::size_t(cy) * std::size_t(words);
+        const bool rowVisible = cy >= vy0 && cy < vy1;
+        for (int cx = 0; cx < cw; ++cx) {
+            const std::size_t c = std::size_t(cy * cw + cx);
+            if (hit[c]) { quiet[c] = 0; hit[c] = 0; }
+            else if (quiet[c] < 0xFFFF) ++quiet[c];
+
+            const bool visible = rowVisible && cx >= vx0 && cx < vx1;
+            const bool active = quiet[c] < activeWindow;
+            const int p = periods[(visible ? 0 : 2) + (active ? 0 : 1)];
+            per[c] = std::uint8_t(p);
+            // Fase escalonada por chunk: los de periodo N se reparten entre N ticks
+            if ((tick + c) & std::uint64_t(p - 1)) continue;
+
+            // Un chunk son 32 bits alineados dentro de un u64
+            row[cx >> 1] |= std::uint64_t(0xFFFFFFFFu) << ((cx & 1) << 5);
+            ++ran;
+        }
+    }
+}
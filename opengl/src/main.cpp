@@ -1,11 +1,23 @@
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include "engine.h"
 #include "material.h"
 #include "renderer.h"
 #include "ui.h"
 #include "audio.h"
+#include "recorder.h"
+#include "history.h"
+#include "governor.h"
+#include "alloc_count.h"
+#include "scene.h"
+#ifdef FS_HAVE_SHM
+#include "shm_publisher.h"
+#endif
 
 static int winW = 1280, winH = 720;
 static int gridW = 320, gridH = 180;
@@ -18,14 +30,34 @@ static Engine engine = Engine(gridW, gridH);
 static Renderer* renderer = nullptr;
 static UI ui;
 static Audio audio;
+static DeltaRecorder recorder;
+// update() puede correr varios ticks por frame: se graba cada uno. El dirty-rect se lee
+// sin consumirlo, asi que cubre todo lo cambiado desde el ultimo takeDirtyRect()
+struct RecordEachTick : TickObserver {
+    void ticked(const Engine& e) override { if (recorder.isOpen()) recorder.capture(e); }
+};
+static RecordEachTick recordTicks;
+static History history;
+static FrameGovernor governor;
+#ifdef FS_HAVE_SHM
+static ShmPublisher shm;
+#endif
 
 static void mouse_button_callback(GLFWwindow* w, int b, int a, int m) {
-    if (b == GLFW_MOUSE_BUTTON_LEFT) lmbDown = (a != GLFW_RELEASE);
+    if (b == GLFW_MOUSE_BUTTON_LEFT) {
+        // Cada trazo es un paso de deshacer: checkpoint justo antes de empezarlo
+        if (a == GLFW_PRESS && !lmbDown) history.checkpoint();
+        lmbDown = (a != GLFW_RELEASE);
+    }
 }
 static void scroll_callback(GLFWwindow*, double, double yoff) {
     brushSize += (int)yoff; if (brushSize < 1) brushSize = 1;
 }
-static void key_callback(GLFWwindow*, int key, int, int action, int) {
+static void key_callback(GLFWwindow*, int key, int, int action, int mods) {
+    if (action != GLFW_PRESS && action != GLFW_REPEAT) return;
+    const bool ctrl = (mods & GLFW_MOD_CONTROL) != 0;
+    if (ctrl && key == GLFW_KEY_Z) { if (mods & GLFW_MOD_SHIFT) history.redo(); else history.undo(); return; }
+    if (ctrl && key == GLFW_KEY_Y) { history.redo(); return; }
     if (action != GLFW_PRESS) return;
     switch (key) {
     case GLFW_KEY_1: brushMat = Material::Sand;  break;
@@ -37,6 +69,14 @@ static void key_callback(GLFWwindow*, int key, int, int action, int) {
     case GLFW_KEY_9: brushMat = Material::Empty; break;
     case GLFW_KEY_P: engine.paused = !engine.paused; break;
     case GLFW_KEY_N: engine.stepOnce = true; break;
+    case GLFW_KEY_G:
+        governor.enabled = !governor.enabled;
+        std::fprintf(stderr, "governor: %s\n", governor.enabled ? "activado" : "desactivado");
+        break;
+    case GLFW_KEY_F5:
+        if (recorder.isOpen()) recorder.close();
+        else recorder.open("recording.fsr", gridW, gridH);
+        break;
     default: break;
     }
 }
@@ -56,17 +96,65 @@ int main() {
     glfwSetScrollCallback(window, scroll_callback);
     glfwSetKeyCallback(window, key_callback);
 
-    engine = Engine(gridW, gridH);
+    // Materiales desde fichero (si falta, se quedan los de serie)
+    if (!loadMaterialFile(MATERIAL_DIR "/default.mat"))
+        std::fprintf(stderr, "No se pudo cargar " MATERIAL_DIR "/default.mat, usando materiales de serie\n");
+
+    // FALLINGSAND_MODE=margolus cambia el motor de simulacion (por defecto, scan)
+    const char* modeName = std::getenv("FALLINGSAND_MODE");
+    const bool margolus = modeName && !std::strcmp(modeName, "margolus");
+    engine = Engine(gridW, gridH, 0x9E3779B9u, margolus ? SimMode::Margolus : SimMode::Scan);
+    history.attach(engine);
+    engine.maxStepsPerUpdate = 4;
+    engine.observer = &recordTicks;
+    // FALLINGSAND_LOD=1: LOD temporal. La ventana muestra el mundo entero, asi que solo
+    // bajan de ritmo los chunks sin actividad reciente
+    if (const char* lod = std::getenv("FALLINGSAND_LOD")) engine.enableLod(std::atoi(lod) != 0);
+    // El bloom solo se calcula alrededor de las celdas emisivas (FALLINGSAND_BLOOM_CULL=0:
+    // pantalla completa, para comparar)
+    const char* bloomCull = std::getenv("FALLINGSAND_BLOOM_CULL");
+    engine.trackEmissive(!bloomCull || std::atoi(bloomCull) != 0);
+#ifdef FS_HAVE_SHM
+    // Opcional: FALLINGSAND_SHM=<nombre> publica el plano en /dev/shm/<nombre>
+    if (const char* shmName = std::getenv("FALLINGSAND_SHM")) {
+        if (!shm.create(shmName, gridW, gridH))
+            std::fprintf(stderr, "No se pudo crear /dev/shm/%s\n", shmName);
+    }
+#endif
     renderer = new Renderer();
+    // FALLINGSAND_CELL_CACHE=0 vuelve al sombreado completo por pixel (comparar)
+    if (const char* cc = std::getenv("FALLINGSAND_CELL_CACHE")) renderer->setCellCache(std::atoi(cc) != 0);
+    // FALLINGSAND_TILED=N fuerza la rejilla en teselas de NxN (sin el, solo si no cabe en
+    // una textura)
+    if (const char* tl = std::getenv("FALLINGSAND_TILED")) renderer->setTiledTextures(std::atoi(tl));
+    // FALLINGSAND_TARGET_FPS fija el objetivo del governor (por defecto 60)
+    if (const char* fps = std::getenv("FALLINGSAND_TARGET_FPS")) {
+        const double f = std::atof(fps);
+        if (f > 0.0) governor = FrameGovernor(1000.0 / f);
+    }
 
     audio.init();
     ui.init();
 
+    // FALLINGSAND_ALLOC_CHECK=N: tras kAllocWarmup frames de calentamiento, vigila las
+    // reservas de memoria de los N frames siguientes y sale con codigo 1 si alguno
+    // reservo. Necesita -DFALLINGSAND_ALLOC_COUNT=ON; arranca con una escena aleatoria
+    // para que haya simulacion, audio y dirty-rects (sin tocar el raton)
+    constexpr int kAllocWarmup = 120;
+    int allocCheck = 0, allocFrame = 0, allocBadFrames = 0;
+    if (const char* ac = std::getenv("FALLINGSAND_ALLOC_CHECK")) {
+        if (!allocCountEnabled())
+            std::fprintf(stderr, "alloc-check: compilado sin FALLINGSAND_ALLOC_COUNT, se ignora\n");
+        else if ((allocCheck = std::atoi(ac)) > 0)
+            seedRandomScene(engine, 1);
+    }
+
     auto t0 = std::chrono::high_resolution_clock::now();
     double fpsTimer = 0.0;
     int frames = 0;
 
     while (!glfwWindowShouldClose(window)) {
+        const std::uint64_t allocs0 = allocCount(), allocBytes0 = allocBytes();
         glfwPollEvents();
 
         auto t1 = std::chrono::high_resolution_clock::now();
@@ -78,14 +166,23 @@ int main() {
         int gy = int((my / double(winH)) * gridH);
         ui.setMouse(mx, my, lmbDown);
 
-        engine.update(dt);
+        // Con el governor en los ultimos niveles la simulacion va a camara lenta
+        engine.update(dt * governor.simRate());
         
         audio.update(engine);
 
+#ifdef FS_HAVE_SHM
+        if (shm.isOpen()) shm.publish(engine);
+#endif
+
         int rx = 0, ry = 0, rw = 0, rh = 0;
         bool hasDirty = engine.takeDirtyRect(rx, ry, rw, rh);
         if (!hasDirty) { rw = rh = 0; }
 
+        int emissive[4 * 8];
+        const int nEmissive = engine.emissiveRects(emissive, 8);
+        // Sin seguimiento el motor no sabe donde brilla nada: bloom completo
+        renderer->setBloomRegions(emissive, engine.emissiveTracked() ? nEmissive : -1);
         renderer->drawPlane(engine.planeM(), gridW, gridH, winW, winH, rx, ry, rw, rh);
 
         ui.begin(winW, winH);
@@ -107,11 +204,32 @@ int main() {
             frames = 0;
         }
 
+        // Trabajo del frame sin la espera del swap (ver FrameGovernor)
+        const double workMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t1).count();
+        if (governor.frame(dt * 1000.0, workMs)) renderer->setQuality(governor.quality());
+
         glfwSwapBuffers(window);
         glfwGetWindowSize(window, &winW, &winH);
+
+        if (allocCheck > 0 && ++allocFrame > kAllocWarmup) {
+            const std::uint64_t n = allocCount() - allocs0;
+            if (n > 0 && allocBadFrames++ < 10)
+                std::fprintf(stderr, "alloc-check: frame %d: %llu reservas, %llu bytes\n", allocFrame,
+                    (unsigned long long)n, (unsigned long long)(allocBytes() - allocBytes0));
+            if (allocFrame == kAllocWarmup + allocCheck) break;
+        }
     }
+    recorder.close();
+#ifdef FS_HAVE_SHM
+    shm.close();
+#endif
     ui.shutdown();
     audio.shutdown();
 
+    if (allocCheck > 0) {
+        std::fprintf(stderr, "alloc-check: %d de %d frames con reservas tras el calentamiento\n",
+            allocBadFrames, std::max(0, allocFrame - kAllocWarmup));
+        return allocBadFrames > 0 ? 1 : 0;
+    }
     return 0;
 }
@@ -1,105 +1,484 @@
 #include <array>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <vector>
 #include "material.h"
 #include "engine.h"
+#include "utils.h"
 
 static std::array<MatProps, 256> g_mat{};
+static bool g_registered = false;
 
 const MatProps& matProps(u8 id) { return g_mat[id]; }
 
-static void SandUpdate(Engine& E, int x, int y, const Cell& self) {
+// ----------------------- tablas compiladas -----------------------
+// Reglas de reaccion: self con vecino 'other' en 'dirs' -> 'out' con probabilidad 'prob'
+struct ReactionRule {
+    u8 self, other, out;
+    float prob;
+    u8 dirs;
+};
+// Decaimiento espontaneo: self -> out; 'idle' solo si no pudo moverse
+struct DecayRule {
+    u8 self, out;
+    float prob;
+    bool idle;
+};
 
-    if (E.tryMove(x, y, 0, +1, self)) return; // caer
+static std::vector<ReactionRule>& reactionRules() { static std::vector<ReactionRule> r; return r; }
+static std::vector<DecayRule>& decayRules() { static std::vector<DecayRule> r; return r; }
+static std::array<std::string, 256>& nameStore() { static std::array<std::string, 256> n; return n; }
 
+// Vecindario: bit i -> (kNbDx[i], kNbDy[i])
+static constexpr int kNbDx[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+static constexpr int kNbDy[8] = { -1,-1,-1,  0, 0,  1, 1, 1 };
+static constexpr u8 kDirAny = 0xFF, kDirUp = 1u << 1, kDirDown = 1u << 6, kDirSide = (1u << 3) | (1u << 4);
+static constexpr u8 kNoReaction = (u8)Material::NullCell;
+static constexpr std::uint16_t kProbAlways = 0xFFFF;
 
-    if (E.inRange(x, y + 1) && E.read(x, y + 1).m == (u8)Material::Water && E.trySwap(x, y, 0, +1, self)) return;
+static u8 g_displace[256][256];          // 1 si a puede ocupar la celda de b
+static u8 g_reactOut[256][256];          // resultado de self junto a vecino; kNoReaction si nada
+static std::uint16_t g_reactProb[256][256];
+static u8 g_reactDirs[256][256];         // vecinos (bits) en los que aplica
+static u8 g_reactMask[256];              // union de g_reactDirs[self][*]
+static u8 g_decayOut[256];
+static std::uint16_t g_decayProb[256];
+static bool g_decayIdle[256];
+
+static std::uint16_t probThreshold(float p) {
+    if (p >= 1.0f) return kProbAlways;
+    if (p <= 0.0f) return 0;
+    return (std::uint16_t)(p * 65535.0f);
+}
+// Con LOD el chunk representa tickScale() ticks: la probabilidad se escala (aprox.
+// lineal de 1-(1-p)^N, saturada)
+static bool roll(Engine& E, std::uint16_t thr) {
+    if (thr == kProbAlways) return true;
+    const std::uint32_t t = std::min<std::uint32_t>(std::uint32_t(thr) * std::uint32_t(E.tickScale()), 0x10000u);
+    return (E.rand32() & 0xFFFFu) < t;
+}
+
+// -------------------------- kernels ---------------------------
+// Acelera en vertical y devuelve cuantas celdas intenta caer este tick (o en los
+// tickScale() ticks que cubre la actualizacion con LOD)
+static int fallSteps(const Engine& E, Cell& c) {
+    const int k = E.tickScale();
+    c.vy = std::min(c.vy + E.gravity * k, E.maxFallSpeed);
+    return std::max(1, c.vy / Engine::velOne) * k;
+}
+
+// Celdas laterales alcanzables en direccion d; se detiene en el primer hueco para caer
+static int lateralReach(const Engine& E, int x, int y, int d, int span) {
+    int n = 0;
+    for (int k = 1; k <= span; ++k) {
+        if (!E.nbVacant(x + d * k, y)) break;
+        n = k;
+        if (E.nbVacant(x + d * k, y + 1)) break;
+    }
+    return n;
+}
+
+// Ocupa una celda vacia o desplaza a un fluido menos denso
+static bool tryDisplace(Engine& E, int x, int y, int dx, int dy, const Cell& c) {
+    u8 b = E.nbNext(x + dx, y + dy);
+    if (b == (u8)Material::Empty) return E.tryMove(x, y, dx, dy, c);
+    return g_displace[c.m][b] && E.trySwap(x, y, dx, dy, c);
+}
+
+// Decaimiento + reacciones con vecinos; true si la celda cambio de material
+static bool react(Engine& E, int x, int y, const Cell& self) {
+    const u8 a = self.m;
+    if (g_decayProb[a] && !g_decayIdle[a] && roll(E, g_decayProb[a])) {
+        E.setCell(x, y, g_decayOut[a]);
+        return true;
+    }
+    const u8 mask = g_reactMask[a];
+    if (!mask) return false;
+    for (int i = 0; i < 8; ++i) {
+        if (!(mask & (1u << i))) continue;
+        const u8 b = E.nbM(x + kNbDx[i], y + kNbDy[i]);
+        const u8 out = g_reactOut[a][b];
+        if (out == kNoReaction || !(g_reactDirs[a][b] & (1u << i))) continue;
+        if (roll(E, g_reactProb[a][b])) {
+            E.setCell(x, y, out);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Sin movimiento posible: decaimiento "idle" y reposo de la velocidad
+static void idle(Engine& E, int x, int y, const Cell& self) {
+    const u8 a = self.m;
+    if (g_decayIdle[a] && g_decayProb[a] && roll(E, g_decayProb[a])) {
+        E.setCell(x, y, g_decayOut[a]);
+        return;
+    }
+    if (self.vx != 0 || self.vy != 0) E.setVelocity(x, y, 0, 0);
+}
+
+static void StaticUpdate(Engine& E, int x, int y, const Cell& self) {
+    if (!react(E, x, y, self)) idle(E, x, y, self);
+}
+
+static void PowderUpdate(Engine& E, int x, int y, const Cell& self) {
+    if (react(E, x, y, self)) return;
+
+    Cell c = self;
+    int steps = fallSteps(E, c);
+    int n = E.castRay(x, y, 0, +1, steps);
+    if (n > 0 && E.tryMove(x, y, 0, n, c)) return; // caer
+    c.vy = 0;
+
+    if (tryDisplace(E, x, y, 0, +1, c)) return;    // hundirse en fluidos
 
     bool leftFirst = !Engine::randbit(x, y, 0);
     int da = leftFirst ? -1 : +1, db = -da;
+    if (tryDisplace(E, x, y, da, +1, c)) return;
+    if (tryDisplace(E, x, y, db, +1, c)) return;
+    idle(E, x, y, self);
+}
 
-    if ((Material)E.read(x + da, y + 1).m == Material::Water && E.trySwap(x, y, da, +1, self)) return;
-    if ((Material)E.read(x + db, y + 1).m == Material::Water && E.trySwap(x, y, db, +1, self)) return;
+static void LiquidUpdate(Engine& E, int x, int y, const Cell& self) {
+    if (react(E, x, y, self)) return;
 
-    if (E.tryMove(x, y, da, +1, self)) return;
-    E.tryMove(x, y, db, +1, self);
-}
+    Cell c = self;
+    int steps = fallSteps(E, c);
+    int n = E.castRay(x, y, 0, +1, steps);
+    if (n > 0 && E.tryMove(x, y, 0, n, c)) return;
+    c.vy = 0;
+
+    if (tryDisplace(E, x, y, 0, +1, c)) return;
 
-static void WaterUpdate(Engine& E, int x, int y, const Cell& self) {
-    if (E.tryMove(x, y, 0, +1, self)) return;
-    bool leftFirst = !Engine::randbit(x, y, 1);
+    // vx recuerda el sentido del ultimo desplazamiento lateral
+    bool leftFirst = c.vx != 0 ? c.vx < 0 : !Engine::randbit(x, y, 1);
     int da = leftFirst ? -1 : +1, db = -da;
 
-    if ((Material)E.read(x + da, y + 1).m == Material::Empty && E.tryMove(x, y, da, +1, self)) return;
-    if ((Material)E.read(x + db, y + 1).m == Material::Empty && E.tryMove(x, y, db, +1, self)) return;
+    if (tryDisplace(E, x, y, da, +1, c)) return;
+    if (tryDisplace(E, x, y, db, +1, c)) return;
 
-    if ((Material)E.read(x + da, y).m == Material::Empty && E.tryMove(x, y, da, 0, self)) return;
-    E.tryMove(x, y, db, 0, self);
+    int span = std::max<int>(1, g_mat[self.m].dispersion) * E.tickScale();
+    if ((n = lateralReach(E, x, y, da, span)) > 0) { c.vx = da; E.tryMove(x, y, da * n, 0, c); return; }
+    if ((n = lateralReach(E, x, y, db, span)) > 0) { c.vx = db; E.tryMove(x, y, db * n, 0, c); return; }
+    idle(E, x, y, self);
 }
 
-static void WoodUpdate(Engine& E, int x, int y, const Cell& self) {
-    bool burn = false;
-    for (int dy = -1; dy <= 1 && !burn; dy++) {
-        for (int dx = -1; dx <= 1 && !burn; dx++) {
-            if ((dx != 0 || dy != 0) && E.inRange(x + dx, y + dy)) {
-                if (E.read(x + dx, y + dy).m == (u8)Material::Fire) {
-                    burn = true;
-                }
-            }
+static void GasUpdate(Engine& E, int x, int y, const Cell& self) {
+    if (react(E, x, y, self)) return;
+
+    const int up = E.castRay(x, y, 0, -1, E.tickScale());
+    if (up > 0 && E.tryMove(x, y, 0, -up, self)) return;
+
+    bool leftFirst = !E.randbit(x, y, 0);
+    int dxa = leftFirst ? -1 : +1, dxb = -dxa;
+    if (E.tryMove(x, y, dxa, -1, self)) return;
+    if (E.tryMove(x, y, dxb, -1, self)) return;
+    idle(E, x, y, self);
+}
+
+// ----------------------- bloque Margolus -----------------------
+// Vecinos de cada celda dentro del bloque y su bit de direccion (kNbDx/kNbDy)
+static constexpr int kBlockNb[4][3] = { {1, 2, 3}, {0, 3, 2}, {0, 3, 1}, {1, 2, 0} };
+static constexpr u8 kBlockDir[4][3] = {
+    { 1u << 4, 1u << 6, 1u << 7 },  // arriba-izq: der, abajo, abajo-der
+    { 1u << 3, 1u << 6, 1u << 5 },  // arriba-der: izq, abajo, abajo-izq
+    { 1u << 1, 1u << 4, 1u << 2 },  // abajo-izq:  arriba, der, arriba-der
+    { 1u << 1, 1u << 3, 1u << 0 },  // abajo-der:  arriba, izq, arriba-izq
+};
+
+static bool blockRoll(std::uint32_t& r, std::uint16_t thr) {
+    r ^= r << 13; r ^= r >> 17; r ^= r << 5;
+    return thr == kProbAlways || (r & 0xFFFFu) < thr;
+}
+
+static bool falls(u8 m) {
+    const Movement mv = g_mat[m].movement;
+    return mv == Movement::Powder || mv == Movement::Liquid;
+}
+
+bool blockRule(Cell q[4], std::uint32_t rnd) {
+    std::uint32_t r = rnd | 1u;
+    bool changed = false;
+    bool done[4] = {};      // ya reacciono o se movio este tick
+
+    // Decaimiento + reacciones contra los materiales de partida del bloque
+    const u8 m0[4] = { q[0].m, q[1].m, q[2].m, q[3].m };
+    for (int i = 0; i < 4; ++i) {
+        const u8 a = m0[i];
+        if (a == (u8)Material::Empty || a == (u8)Material::NullCell) continue;
+        if (g_decayProb[a] && !g_decayIdle[a] && blockRoll(r, g_decayProb[a])) {
+            q[i] = Cell{ g_decayOut[a] }; done[i] = changed = true;
+            continue;
+        }
+        if (!g_reactMask[a]) continue;
+        for (int k = 0; k < 3; ++k) {
+            const u8 b = m0[kBlockNb[i][k]];
+            const u8 out = g_reactOut[a][b];
+            if (out == kNoReaction || !(g_reactDirs[a][b] & kBlockDir[i][k])) continue;
+            if (blockRoll(r, g_reactProb[a][b])) { q[i] = Cell{ out }; done[i] = changed = true; break; }
         }
     }
-    if (burn) {
-        E.setCell(x, y, (u8)Material::Fire);
+
+    bool moved[4] = {};
+    auto swapCells = [&](int a, int b) {
+        std::swap(q[a], q[b]);
+        q[a].vx = q[a].vy = 0; q[b].vx = q[b].vy = 0;
+        moved[a] = moved[b] = true;
+        changed = true;
+    };
+
+    // Vertical por columnas: caer (o hundirse en un fluido menos denso) y subir gases
+    for (int c = 0; c < 2; ++c) {
+        const u8 t = q[c].m, b = q[c + 2].m;
+        if (falls(t) && g_displace[t][b]) swapCells(c, c + 2);
+        else if (g_mat[b].movement == Movement::Gas && t == (u8)Material::Empty) swapCells(c, c + 2);
     }
-}
 
-static void FireUpdate(Engine& E, int x, int y, const Cell& self) {
-    if ((rand() % 100) < 5) {
-        E.setCell(x, y, (u8)Material::Empty);
-        return;
+    // Diagonales, empezando por un lado al azar
+    blockRoll(r, kProbAlways);
+    const int first = int(r & 1u);
+    for (int k = 0; k < 2; ++k) {
+        const int c = first ^ k, o = c ^ 1;
+        const u8 t = q[c].m;
+        if (!moved[c] && !moved[o + 2] && falls(t) && g_displace[t][q[o + 2].m]) { swapCells(c, o + 2); continue; }
+        const u8 b = q[c + 2].m;
+        if (!moved[c + 2] && !moved[o] && g_mat[b].movement == Movement::Gas && q[o].m == (u8)Material::Empty)
+            swapCells(c + 2, o);
+    }
+
+    // Liquidos y gases se extienden en horizontal (paseo aleatorio)
+    for (int row = 0; row < 4; row += 2) {
+        if (moved[row] || moved[row + 1] || !(r & (2u << row))) continue;
+        const u8 a = q[row].m, b = q[row + 1].m;
+        const Movement ma = g_mat[a].movement, mb = g_mat[b].movement;
+        const bool fa = ma == Movement::Liquid || ma == Movement::Gas;
+        const bool fb = mb == Movement::Liquid || mb == Movement::Gas;
+        if ((fa && b == (u8)Material::Empty) || (fb && a == (u8)Material::Empty)) swapCells(row, row + 1);
     }
 
-    if (E.inRange(x, y - 1) && E.read(x, y-1).m == (u8)Material::Empty) {
-        if ((rand() % 100) < 20) {
-            E.setCell(x, y, (u8)Material::Smoke);
+    // Lo que no pudo moverse: decaimiento "idle" y reposo de la velocidad
+    for (int i = 0; i < 4; ++i) {
+        if (moved[i] || done[i]) continue;
+        const u8 a = q[i].m;
+        if (g_decayIdle[a] && g_decayProb[a] && blockRoll(r, g_decayProb[a])) { q[i] = Cell{ g_decayOut[a] }; changed = true; }
+        else if (q[i].vx != 0 || q[i].vy != 0) { q[i].vx = q[i].vy = 0; changed = true; }
+    }
+    return changed;
+}
+
+// Rellena las tablas planas a partir de g_mat + reglas
+static void compileMaterialTables() {
+    for (int a = 0; a < 256; ++a) {
+        g_reactMask[a] = 0;
+        g_decayOut[a] = kNoReaction; g_decayProb[a] = 0; g_decayIdle[a] = false;
+        for (int b = 0; b < 256; ++b) {
+            const MatProps& pa = g_mat[a];
+            const MatProps& pb = g_mat[b];
+            bool fluid = pb.movement == Movement::Liquid || pb.movement == Movement::Gas;
+            g_displace[a][b] = (b == (u8)Material::Empty) ||
+                (a != b && fluid && pa.density > pb.density && b != (u8)Material::NullCell);
+            g_reactOut[a][b] = kNoReaction;
+            g_reactProb[a][b] = 0;
+            g_reactDirs[a][b] = 0;
         }
     }
 
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            if ((dx != 0 || dy != 0) && E.inRange(x + dx, y + dy)) {
-                if (E.read(x + dx, y + dy).m  == (u8)Material::Wood) {
-                    E.setCell(x, y, (u8)Material::Fire);
-                }
-            }
+    for (const ReactionRule& r : reactionRules()) {
+        g_reactOut[r.self][r.other] = r.out;
+        g_reactProb[r.self][r.other] = probThreshold(r.prob);
+        g_reactDirs[r.self][r.other] = r.dirs;
+        g_reactMask[r.self] |= r.dirs;
+    }
+    for (const DecayRule& d : decayRules()) {
+        g_decayOut[d.self] = d.out;
+        g_decayProb[d.self] = probThreshold(d.prob);
+        g_decayIdle[d.self] = d.idle;
+    }
+
+    for (int a = 1; a < 256; ++a) {
+        MatProps& mp = g_mat[a];
+        if (mp.name.empty()) { mp.update = nullptr; continue; }
+        switch (mp.movement) {
+        case Movement::Powder: mp.update = &PowderUpdate; break;
+        case Movement::Liquid: mp.update = &LiquidUpdate; break;
+        case Movement::Gas:    mp.update = &GasUpdate; break;
+        case Movement::Static:
+            mp.update = (g_reactMask[a] || g_decayProb[a]) ? &StaticUpdate : nullptr;
+            break;
         }
+        // Un estatico que solo reacciona es un no-op mientras ningun vecino pueda
+        // activar una de sus reglas (con prob < 1 ni siquiera tira del RNG)
+        if (!mp.update) mp.updateClass = UpdateClass::Static;
+        else if (mp.movement == Movement::Static && !g_decayProb[a]) mp.updateClass = UpdateClass::Reactive;
+        else mp.updateClass = UpdateClass::Active;
+        mp.wakesReactive = false;
     }
+    g_mat[(u8)Material::Empty].update = nullptr;
+    g_mat[(u8)Material::Empty].updateClass = UpdateClass::Static;
+    g_mat[(u8)Material::Empty].wakesReactive = false;
+    for (const ReactionRule& r : reactionRules())
+        if (g_mat[r.self].updateClass == UpdateClass::Reactive) g_mat[r.other].wakesReactive = true;
+    g_registered = true;
 }
 
-static void SmokeUpdate(Engine& E, int x, int y, const Cell& self) {
+void registerDefaultMaterials() {
 
-    if (E.tryMove(x, y, 0, -1, self)) return;
+    //MatProp                           //NAME      //Color             //Densidad  //Emissive  //Dispersion    //Movimiento
+    g_mat[(u8)Material::Empty] =    {   "Empty",    0,0,0,0,           0,           1.0f,       0,              Movement::Static };
+    g_mat[(u8)Material::Sand] =     {   "Sand",     217,191,77,255,    3,           1.0f,       0,              Movement::Powder };
+    g_mat[(u8)Material::Water] =    {   "Water",    51,102,230,200,    1,           1.0f,       5,              Movement::Liquid };
+    g_mat[(u8)Material::Stone] =    {   "Stone",    128,128,140,255,   255,         1.0f,       0,              Movement::Static };
+    g_mat[(u8)Material::Wood] =     {   "Wood",     142,86,55,255,     255,         1.0f,       0,              Movement::Static };
+    g_mat[(u8)Material::Fire] =     {   "Fire",     255,35,1,255,      255,         5.5f,       0,              Movement::Static };
+    g_mat[(u8)Material::Smoke] =    {   "Smoke",    28,13,2,255,       255,         1.0f,       0,              Movement::Gas };
 
+    reactionRules() = {
+        //Self                  //Vecino                //Resultado             //Prob  //Direcciones
+        { (u8)Material::Wood,   (u8)Material::Fire,     (u8)Material::Fire,     1.00f,  kDirAny },
+        { (u8)Material::Fire,   (u8)Material::Empty,    (u8)Material::Smoke,    0.20f,  kDirUp },
+    };
+    decayRules() = {
+        { (u8)Material::Fire,   (u8)Material::Empty,    0.05f,  false },
+        { (u8)Material::Smoke,  (u8)Material::Empty,    0.02f,  true },
+    };
+    g_mat[(u8)Material::Smoke].tickRate = 2;
+    compileMaterialTables();
+}
 
-    bool leftFirst = !E.randbit(x, y, 0);
-    int dxa = leftFirst ? -1 : +1, dxb = -dxa;
+void ensureMaterials() {
+    if (!g_registered) registerDefaultMaterials();
+}
 
-    if (E.tryMove(x, y, dxa, -1, self)) return;
-    if (E.tryMove(x, y, dxb, -1, self)) return;
+u8 findMaterial(std::string_view name) {
+    for (int i = 0; i < 256; ++i)
+        if (!g_mat[i].name.empty() && g_mat[i].name == name) return (u8)i;
+    return (u8)Material::NullCell;
+}
 
-    if ((rand() % 100) < 2) {
-        E.setCell(x, y, (u8)Material::Empty);
-    }
+// ----------------------- fichero de definicion -----------------------
+static bool parseMovement(const std::string& s, Movement& out) {
+    if (s == "static") out = Movement::Static;
+    else if (s == "powder") out = Movement::Powder;
+    else if (s == "liquid") out = Movement::Liquid;
+    else if (s == "gas") out = Movement::Gas;
+    else return false;
+    return true;
+}
+static bool parseDirs(const std::string& s, u8& out) {
+    if (s == "any") out = kDirAny;
+    else if (s == "up") out = kDirUp;
+    else if (s == "down") out = kDirDown;
+    else if (s == "side") out = kDirSide;
+    else if (s == "adjacent") out = kDirUp | kDirDown | kDirSide;
+    else return false;
+    return true;
 }
 
-static void StoneUpdate(Engine&, int, int, const Cell&) { /* inmvil */ }
+bool loadMaterialFile(const char* path) {
+    std::string text = readTextFile(path);
+    if (text.empty()) return false;
 
-void registerDefaultMaterials() {
+    std::array<MatProps, 256> mats{};
+    std::array<std::string, 256> names;
+    std::vector<ReactionRule> reactions;
+    std::vector<DecayRule> decays;
 
-    //MatProp                           //NAME      //Color             //Densidad  //Emissive
-    g_mat[(u8)Material::Empty] =    {   "Empty",    0,0,0,0,           0,           1.0f,       nullptr };
-    g_mat[(u8)Material::Sand] =     {   "Sand",     217,191,77,255,    3,           1.0f,       &SandUpdate };
-    g_mat[(u8)Material::Water] =    {   "Water",    51,102,230,200,    1,           1.0f,       &WaterUpdate };
-    g_mat[(u8)Material::Stone] =    {   "Stone",    128,128,140,255,   255,         1.0f,       &StoneUpdate };
-    g_mat[(u8)Material::Wood] =     {   "Wood",     142,86,55,255,     255,         1.0f,       &WoodUpdate };
-    g_mat[(u8)Material::Fire] =     {   "Fire",     255,35,1,255,      255,         5.5f,       &FireUpdate };
-    g_mat[(u8)Material::Smoke] =    {   "Smoke",    28,13,2,255,       255,         1.0f,       &SmokeUpdate };
-}
\ No newline at end of file
+    // Las reglas pueden nombrar materiales declarados despues: se resuelven al final
+    struct PendingRule { std::string self, other, out; float prob; std::string mode; int line; bool decay; };
+    std::vector<PendingRule> pending;
+    struct PendingRate { std::string self; int ticks; int line; };
+    std::vector<PendingRate> rates;
+
+    std::istringstream in(text);
+    std::string line;
+    int lineNo = 0, materials = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (auto hash = line.find('#'); hash != std::string::npos) line.resize(hash);
+        std::istringstream ls(line);
+        std::vector<std::string> tok;
+        for (std::string t; ls >> t; ) if (t != "->" && t != "+") tok.push_back(t);
+        if (tok.empty()) continue;
+
+        bool ok = false;
+        if (tok[0] == "material" && (tok.size() == 10 || tok.size() == 11)) {
+            int id = std::atoi(tok[1].c_str());
+            Movement mv;
+            if (id >= 0 && id < 255 && parseMovement(tok[9], mv)) {
+                names[id] = tok[2];
+                MatProps& mp = mats[id];
+                mp.r = (u8)std::atoi(tok[3].c_str());
+                mp.g = (u8)std::atoi(tok[4].c_str());
+                mp.b = (u8)std::atoi(tok[5].c_str());
+                mp.a = (u8)std::atoi(tok[6].c_str());
+                mp.density = (u8)std::atoi(tok[7].c_str());
+                mp.emissive = (float)std::atof(tok[8].c_str());
+                mp.movement = mv;
+                mp.dispersion = tok.size() == 11 ? (u8)std::atoi(tok[10].c_str()) : 0;
+                ++materials;
+                ok = true;
+            }
+        }
+        else if (tok[0] == "react" && (tok.size() == 5 || tok.size() == 6)) {
+            pending.push_back({ tok[1], tok[2], tok[3], (float)std::atof(tok[4].c_str()),
+                tok.size() == 6 ? tok[5] : "any", lineNo, false });
+            ok = true;
+        }
+        else if (tok[0] == "decay" && (tok.size() == 4 || tok.size() == 5)) {
+            pending.push_back({ tok[1], "", tok[2], (float)std::atof(tok[3].c_str()),
+                tok.size() == 5 ? tok[4] : "always", lineNo, true });
+            ok = true;
+        }
+        else if (tok[0] == "rate" && tok.size() == 3) {
+            rates.push_back({ tok[1], std::atoi(tok[2].c_str()), lineNo });
+            ok = true;
+        }
+        if (!ok) std::fprintf(stderr, "%s:%d: linea ignorada\n", path, lineNo);
+    }
+    // Sin ningun material valido la tabla quedaria vacia: se conserva la actual
+    if (materials == 0) {
+        std::fprintf(stderr, "%s: ningun material valido\n", path);
+        return false;
+    }
+
+    auto lookup = [&](const std::string& n) -> int {
+        for (int i = 0; i < 256; ++i) if (!names[i].empty() && names[i] == n) return i;
+        return -1;
+    };
+    for (const PendingRule& p : pending) {
+        int a = lookup(p.self), o = lookup(p.out), b = p.decay ? 0 : lookup(p.other);
+        u8 dirs = 0;
+        bool ok = a >= 0 && o >= 0 && b >= 0;
+        if (ok && p.decay) {
+            ok = p.mode == "always" || p.mode == "idle";
+            if (ok) decays.push_back({ (u8)a, (u8)o, p.prob, p.mode == "idle" });
+        }
+        else if (ok) {
+            ok = parseDirs(p.mode, dirs);
+            if (ok) reactions.push_back({ (u8)a, (u8)b, (u8)o, p.prob, dirs });
+        }
+        if (!ok) std::fprintf(stderr, "%s:%d: regla con material o modo desconocido\n", path, p.line);
+    }
+    for (const PendingRate& r : rates) {
+        const int a = lookup(r.self);
+        if (a < 0 || r.ticks < 1 || r.ticks > 64 || (r.ticks & (r.ticks - 1))) {
+            std::fprintf(stderr, "%s:%d: rate con material desconocido o que no es potencia de 2 (1..64)\n", path, r.line);
+            continue;
+        }
+        mats[a].tickRate = (u8)r.ticks;
+    }
+
+    // Fichero valido: reemplaza la tabla entera
+    nameStore() = std::move(names);
+    for (int i = 0; i < 256; ++i) {
+        g_mat[i] = mats[i];
+        g_mat[i].name = nameStore()[i];
+    }
+    reactionRules() = std::move(reactions);
+    decayRules() = std::move(decays);
+    compileMaterialTables();
+    return true;
+}
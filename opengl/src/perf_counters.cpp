@@ -0,0 +1,100 @@
+#include "perf_counters.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* PerfCounters::name(int e) {
+    static const char* names[kEvents] = { "cycles", "instructions", "L1d-miss", "LLC-miss", "branch-miss", "dTLB-miss" };
+    return e >= 0 && e < kEvents ? names[e] : "?";
+}
+
+#if defined(__linux__)
+
+static std::uint64_t cacheConfig(std::uint64_t cache, std::uint64_t op, std::uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+bool PerfCounters::open() {
+    const struct { std::uint32_t type; std::uint64_t config; } ev[kEvents] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+    };
+    int opened = 0, lastErrno = 0;
+    for (int e = 0; e < kEvents; ++e) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = ev[e].type;
+        attr.config = ev[e].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // Este hilo, cualquier CPU; sin grupo para que un evento que falte no tumbe al resto
+        fd[e] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd[e] >= 0) ++opened;
+        else lastErrno = errno;
+    }
+    if (opened) return true;
+    if (lastErrno == EACCES || lastErrno == EPERM)
+        err = "sin permiso (mira /proc/sys/kernel/perf_event_paranoid o CAP_PERFMON)";
+    else if (lastErrno == ENOSYS)
+        err = "perf_event_open no disponible (kernel o seccomp del contenedor)";
+    else if (lastErrno == ENOENT || lastErrno == EOPNOTSUPP)
+        err = "la CPU no expone contadores hardware (maquina virtual?)";
+    else
+        err = std::strerror(lastErrno);
+    return false;
+}
+
+PerfCounters::~PerfCounters() {
+    for (int e = 0; e < kEvents; ++e)
+        if (fd[e] >= 0) close(fd[e]);
+}
+
+void PerfCounters::read(Snapshot& s) const {
+    for (int e = 0; e < kEvents; ++e) {
+        std::uint64_t buf[3];
+        s.valid[e] = fd[e] >= 0 && ::read(fd[e], buf, sizeof(buf)) == ssize_t(sizeof(buf));
+        if (!s.valid[e]) continue;
+        s.value[e] = buf[0]; s.enabled[e] = buf[1]; s.running[e] = buf[2];
+    }
+}
+
+#else
+
+bool PerfCounters::open() {
+    err = "solo en Linux (perf_event_open)";
+    return false;
+}
+
+PerfCounters::~PerfCounters() = default;
+
+void PerfCounters::read(Snapshot& s) const {
+    for (int e = 0; e < kEvents; ++e) s.valid[e] = false;
+}
+
+#endif
+
+void PerfCounters::Totals::add(const Snapshot& from, const Snapshot& to) {
+    for (int e = 0; e < kEvents; ++e) {
+        // Un 0 de una lectura fallida haria que la resta diera la vuelta (~2^64)
+        if (!from.valid[e] || !to.valid[e]) continue;
+        sum.value[e] += to.value[e] - from.value[e];
+        sum.enabled[e] += to.enabled[e] - from.enabled[e];
+        sum.running[e] += to.running[e] - from.running[e];
+    }
+}
+
+double PerfCounters::Totals::value(int e) const {
+    if (!sum.running[e]) return 0.0;
+    return double(sum.value[e]) * (double(sum.enabled[e]) / double(sum.running[e]));
+}
@@ -0,0 +1,304 @@
+#include "recorder.h"
+#include <algorithm>
+#include <cstring>
+#include "engine.h"
+#include "world_hash.h"
+
+// v2 anade el stateHash() del motor a cada registro; v1 se sigue leyendo
+static const char kMagic[8] = { 'F', 'S', 'R', 'E', 'C', '0', '0', '2' };
+static const char kMagicV1[8] = { 'F', 'S', 'R', 'E', 'C', '0', '0', '1' };
+static constexpr size_t kRecordHeaderV1 = 1 + 8 + 4 * 5;
+static constexpr size_t kRecordHeader = kRecordHeaderV1 + 8;
+enum : std::uint8_t { kRecKey = 0, kRecDelta = 1 };
+enum : std::uint8_t { kTokZeros = 0, kTokRepeat = 1, kTokLiteral = 2 };
+
+// ---------------------------- util ----------------------------
+static void putU32(std::vector<std::uint8_t>& v, std::uint32_t x) {
+    for (int i = 0; i < 4; ++i) v.push_back(std::uint8_t(x >> (8 * i)));
+}
+static void putU64(std::vector<std::uint8_t>& v, std::uint64_t x) {
+    for (int i = 0; i < 8; ++i) v.push_back(std::uint8_t(x >> (8 * i)));
+}
+static std::uint32_t getU32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) | (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+}
+static std::uint64_t getU64(const std::uint8_t* p) {
+    return std::uint64_t(getU32(p)) | (std::uint64_t(getU32(p + 4)) << 32);
+}
+static void putVarint(std::vector<std::uint8_t>& v, size_t x) {
+    while (x >= 0x80) { v.push_back(std::uint8_t(x | 0x80)); x >>= 7; }
+    v.push_back(std::uint8_t(x));
+}
+static bool getVarint(const std::uint8_t*& p, const std::uint8_t* end, size_t& x) {
+    x = 0;
+    for (int sh = 0; p < end && sh < 63; sh += 7) {
+        std::uint8_t b = *p++;
+        x |= size_t(b & 0x7F) << sh;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// Token = varint(len << 2 | tipo): rachas de cero, rachas repetidas (+1 byte) o literales (+len bytes)
+static void encodeRLE(const std::uint8_t* d, size_t n, std::vector<std::uint8_t>& out) {
+    size_t i = 0, litStart = 0;
+    auto flushLiteral = [&](size_t end) {
+        if (end > litStart) {
+            putVarint(out, ((end - litStart) << 2) | kTokLiteral);
+            out.insert(out.end(), d + litStart, d + end);
+        }
+    };
+    while (i < n) {
+        size_t r = 1;
+        while (i + r < n && d[i + r] == d[i]) ++r;
+        const bool zero = d[i] == 0;
+        if ((zero && r >= 2) || r >= 4) {
+            flushLiteral(i);
+            putVarint(out, (r << 2) | (zero ? kTokZeros : kTokRepeat));
+            if (!zero) out.push_back(d[i]);
+            i += r;
+            litStart = i;
+        }
+        else {
+            i += r;
+        }
+    }
+    flushLiteral(n);
+}
+
+static bool decodeRLE(const std::uint8_t* p, size_t n, std::uint8_t* out, size_t outN) {
+    const std::uint8_t* end = p + n;
+    size_t o = 0, tok;
+    while (p < end) {
+        if (!getVarint(p, end, tok)) return false;
+        const size_t len = tok >> 2;
+        if (o + len > outN) return false;
+        switch (tok & 3u) {
+        case kTokZeros: std::memset(out + o, 0, len); break;
+        case kTokRepeat:
+            if (p >= end) return false;
+            std::memset(out + o, *p++, len);
+            break;
+        case kTokLiteral:
+            if (size_t(end - p) < len) return false;
+            std::memcpy(out + o, p, len); p += len;
+            break;
+        default: return false;
+        }
+        o += len;
+    }
+    return o == outN;
+}
+
+// ---------------------------- recorder ----------------------------
+bool DeltaRecorder::open(const char* path, int gridW, int gridH, int keyframeInterval, size_t maxQueuedBytes) {
+    close();
+    file = std::fopen(path, "wb");
+    if (!file) return false;
+    w = gridW; h = gridH;
+    keyInterval = std::max(1, keyframeInterval);
+    maxQueued = maxQueuedBytes;
+
+    std::vector<std::uint8_t> hdr(kMagic, kMagic + 8);
+    putU32(hdr, std::uint32_t(w)); putU32(hdr, std::uint32_t(h)); putU32(hdr, std::uint32_t(keyInterval));
+    std::fwrite(hdr.data(), 1, hdr.size(), file);
+
+    prev.assign(size_t(w) * size_t(h), 0);
+    scratch.reserve(prev.size());
+    haveKey = false; forceKey = true;
+    recordCount = droppedCount = encodedBytes = 0;
+    stopping = false;
+    queuedBytes = 0;
+    writer = std::thread(&DeltaRecorder::writerLoop, this);
+    return true;
+}
+
+void DeltaRecorder::close() {
+    if (!file) return;
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (writer.joinable()) writer.join();
+    std::fclose(file);
+    file = nullptr;
+    queue.clear(); freeList.clear();
+}
+
+std::vector<std::uint8_t> DeltaRecorder::takeBuffer() {
+    std::lock_guard<std::mutex> lk(mtx);
+    if (freeList.empty()) return {};
+    std::vector<std::uint8_t> b = std::move(freeList.back());
+    freeList.pop_back();
+    return b;
+}
+
+void DeltaRecorder::capture(const Engine& e) {
+    if (!file || e.width() != w || e.height() != h) return;
+
+    int x, y, rw, rh;
+    const bool dirty = e.peekDirtyRect(x, y, rw, rh);
+    const std::uint64_t t = e.ticks();
+    const bool key = forceKey || !haveKey || t - lastKeyTick >= std::uint64_t(keyInterval);
+    if (!key && !dirty) return; // sin cambios: el reproductor mantiene el plano anterior
+
+    const std::uint8_t* plane = e.planeM();
+    std::vector<std::uint8_t> buf = takeBuffer();
+    buf.clear();
+    if (key) { x = 0; y = 0; rw = w; rh = h; }
+
+    buf.push_back(key ? kRecKey : kRecDelta);
+    putU64(buf, t);
+    putU32(buf, std::uint32_t(x)); putU32(buf, std::uint32_t(y));
+    putU32(buf, std::uint32_t(rw)); putU32(buf, std::uint32_t(rh));
+    putU32(buf, 0); // tamano del payload, se rellena al final
+    putU64(buf, e.stateHash());
+
+    if (key) {
+        std::memcpy(prev.data(), plane, prev.size());
+        encodeRLE(plane, prev.size(), buf);
+    }
+    else {
+        scratch.resize(size_t(rw) * size_t(rh));
+        for (int r = 0; r < rh; ++r) {
+            const size_t o = size_t(y + r) * size_t(w) + size_t(x);
+            std::uint8_t* dst = scratch.data() + size_t(r) * size_t(rw);
+            for (int c = 0; c < rw; ++c) dst[c] = std::uint8_t(plane[o + size_t(c)] ^ prev[o + size_t(c)]);
+            std::memcpy(prev.data() + o, plane + o, size_t(rw));
+        }
+        encodeRLE(scratch.data(), scratch.size(), buf);
+    }
+    const std::uint32_t payload = std::uint32_t(buf.size() - kRecordHeader);
+    for (int i = 0; i < 4; ++i) buf[kRecordHeaderV1 - 4 + size_t(i)] = std::uint8_t(payload >> (8 * i));
+
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        if (queuedBytes + buf.size() > maxQueued) {
+            // Disco atascado: se pierde este registro y se resincroniza con un keyframe
+            ++droppedCount;
+            forceKey = true;
+            freeList.push_back(std::move(buf));
+            return;
+        }
+        queuedBytes += buf.size();
+        encodedBytes += buf.size();
+        queue.push_back(std::move(buf));
+    }
+    cv.notify_one();
+    ++recordCount;
+    if (key) { lastKeyTick = t; haveKey = true; forceKey = false; }
+}
+
+void DeltaRecorder::writerLoop() {
+    std::unique_lock<std::mutex> lk(mtx);
+    for (;;) {
+        cv.wait(lk, [&] { return stopping || !queue.empty(); });
+        if (queue.empty()) break; // stopping y cola vacia
+        std::vector<std::uint8_t> buf = std::move(queue.front());
+        queue.pop_front();
+        lk.unlock();
+        std::fwrite(buf.data(), 1, buf.size(), file);
+        lk.lock();
+        queuedBytes -= buf.size();
+        if (freeList.size() < 64) freeList.push_back(std::move(buf));
+    }
+    std::fflush(file);
+}
+
+// ---------------------------- player ----------------------------
+bool DeltaPlayer::open(const char* path) {
+    close();
+    file = std::fopen(path, "rb");
+    if (!file) return false;
+
+    std::uint8_t hdr[20];
+    if (std::fread(hdr, 1, sizeof(hdr), file) != sizeof(hdr)) { close(); return false; }
+    if (std::memcmp(hdr, kMagic, 8) == 0) hashed = true;
+    else if (std::memcmp(hdr, kMagicV1, 8) == 0) hashed = false;
+    else { close(); return false; }
+    const size_t recHeader = hashed ? kRecordHeader : kRecordHeaderV1;
+    w = int(getU32(hdr + 8)); h = int(getU32(hdr + 12));
+
+    // Indice: solo cabeceras, los payloads se leen al reproducir
+    int lastKey = -1;
+    std::uint8_t rh[kRecordHeader];
+    while (std::fread(rh, 1, recHeader, file) == recHeader) {
+        Entry en;
+        en.key = rh[0] == kRecKey;
+        en.tick = getU64(rh + 1);
+        en.x = getU32(rh + 9); en.y = getU32(rh + 13);
+        en.rw = getU32(rh + 17); en.rh = getU32(rh + 21);
+        en.bytes = getU32(rh + 25);
+        en.hash = hashed ? getU64(rh + 29) : 0;
+        en.offset = std::ftell(file);
+        if (en.key) lastKey = int(index.size());
+        if (lastKey < 0) break;     // delta sin keyframe previo: fichero truncado por delante
+        en.keyIndex = lastKey;
+        if (std::fseek(file, long(en.bytes), SEEK_CUR) != 0) break;
+        index.push_back(en);
+    }
+    planeBuf.assign(size_t(w) * size_t(h), 0);
+    planeHash = 0;
+    cur = -1;
+    return !index.empty();
+}
+
+void DeltaPlayer::close() {
+    if (file) { std::fclose(file); file = nullptr; }
+    index.clear();
+    cur = -1;
+}
+
+bool DeltaPlayer::apply(size_t i) {
+    const Entry& en = index[i];
+    payload.resize(en.bytes);
+    if (std::fseek(file, en.offset, SEEK_SET) != 0) return false;
+    if (std::fread(payload.data(), 1, en.bytes, file) != en.bytes) return false;
+
+    if (en.key) {
+        if (!decodeRLE(payload.data(), payload.size(), planeBuf.data(), planeBuf.size())) return false;
+        planeHash = hashPlane(planeBuf.data(), w, h);
+        return true;
+    }
+
+    if (en.x + en.rw > std::uint32_t(w) || en.y + en.rh > std::uint32_t(h)) return false;
+    rectBuf.resize(size_t(en.rw) * size_t(en.rh));
+    if (!decodeRLE(payload.data(), payload.size(), rectBuf.data(), rectBuf.size())) return false;
+    for (std::uint32_t r = 0; r < en.rh; ++r) {
+        std::uint8_t* dst = planeBuf.data() + size_t(en.y + r) * size_t(w) + en.x;
+        const std::uint8_t* src = rectBuf.data() + size_t(r) * en.rw;
+        const size_t row = size_t(en.y + r) * size_t(w) + en.x;
+        // El XOR marca exactamente las celdas cambiadas: el hash se actualiza solo en ellas
+        for (std::uint32_t c = 0; c < en.rw; ++c) {
+            if (!src[c]) continue;
+            const std::uint8_t old = dst[c];
+            dst[c] = std::uint8_t(old ^ src[c]);
+            planeHash ^= zobristDelta(row + c, old, dst[c]);
+        }
+    }
+    return true;
+}
+
+bool DeltaPlayer::seek(std::uint64_t t) {
+    auto it = std::upper_bound(index.begin(), index.end(), t,
+        [](std::uint64_t v, const Entry& e) { return v < e.tick; });
+    if (it == index.begin()) return false;
+    const long target = long(it - index.begin()) - 1;
+    const long key = index[size_t(target)].keyIndex;
+
+    // Hacia delante dentro del mismo tramo: basta con seguir aplicando deltas
+    long from = (cur >= key && cur <= target) ? cur + 1 : key;
+    for (long i = from; i <= target; ++i)
+        if (!apply(size_t(i))) { cur = -1; return false; }
+    cur = target;
+    return true;
+}
+
+bool DeltaPlayer::next() {
+    if (cur + 1 >= long(index.size())) return false;
+    if (cur < 0) return seek(index.front().tick);
+    if (!apply(size_t(cur + 1))) return false;
+    ++cur;
+    return true;
+}
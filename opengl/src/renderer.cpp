@@ -1,6 +1,8 @@
 ﻿#include "renderer.h"
 #include "utils.h"
 #include <glad/gl.h>
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <cstring>
 
@@ -32,8 +34,15 @@ Renderer::~Renderer() {
     if (pingFBO[1]) glDeleteFramebuffers(1, &pingFBO[1]);
 
     if (tex) glDeleteTextures(1, &tex);
+    if (tileTex) glDeleteTextures(1, &tileTex);
+    if (cellTex) glDeleteTextures(1, &cellTex);
+    if (cellFBO) glDeleteFramebuffers(1, &cellFBO);
     if (vao) glDeleteVertexArrays(1, &vao);
 
+    if (progGridCached) glDeleteProgram(progGridCached);
+    if (progGridTiled) glDeleteProgram(progGridTiled);
+    if (progResolve) glDeleteProgram(progResolve);
+
     if (progComposite) glDeleteProgram(progComposite);
     if (progBlur) glDeleteProgram(progBlur);
     if (progThresh) glDeleteProgram(progThresh);
@@ -58,6 +67,7 @@ void Renderer::initOnce() {
     loc_uTex = glGetUniformLocation(progGrid, "uTex");
     loc_uGrid = glGetUniformLocation(progGrid, "uGrid");
     loc_uView = glGetUniformLocation(progGrid, "uView");
+    loc_uEffects = glGetUniformLocation(progGrid, "uEffects");
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
@@ -83,6 +93,34 @@ void Renderer::initOnce() {
     glUniformBlockBinding(progGrid, blk, 0);
     glBindBufferBase(GL_UNIFORM_BUFFER, 0, paletteUBO);
 
+    // --- Caché de color por celda ---
+    std::string fsResolve = readTextFile(SHADER_DIR "/cell_resolve.fs.glsl");
+    std::string fsCached = readTextFile(SHADER_DIR "/grid_cached.fs.glsl");
+    progResolve = makeProgram(vsSrc.c_str(), fsResolve.c_str());
+    progGridCached = makeProgram(vsSrc.c_str(), fsCached.c_str());
+    glUniformBlockBinding(progResolve, glGetUniformBlockIndex(progResolve, "Palette"), 0);
+
+    loc_rs_uTex = glGetUniformLocation(progResolve, "uTex");
+    loc_rs_uGrid = glGetUniformLocation(progResolve, "uGrid");
+    loc_rs_uEffects = glGetUniformLocation(progResolve, "uEffects");
+    loc_gc_uCells = glGetUniformLocation(progGridCached, "uCells");
+    loc_gc_uGrid = glGetUniformLocation(progGridCached, "uGrid");
+    loc_gc_uView = glGetUniformLocation(progGridCached, "uView");
+    loc_gc_uEffects = glGetUniformLocation(progGridCached, "uEffects");
+
+    // --- Rejilla por teselas ---
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTexSize);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxTexLayers);
+    std::string fsTiled = readTextFile(SHADER_DIR "/grid_tiled.fs.glsl");
+    progGridTiled = makeProgram(vsSrc.c_str(), fsTiled.c_str());
+    glUniformBlockBinding(progGridTiled, glGetUniformBlockIndex(progGridTiled, "Palette"), 0);
+    loc_gt_uTiles = glGetUniformLocation(progGridTiled, "uTiles");
+    loc_gt_uTileSize = glGetUniformLocation(progGridTiled, "uTileSize");
+    loc_gt_uTilesX = glGetUniformLocation(progGridTiled, "uTilesX");
+    loc_gt_uGrid = glGetUniformLocation(progGridTiled, "uGrid");
+    loc_gt_uView = glGetUniformLocation(progGridTiled, "uView");
+    loc_gt_uEffects = glGetUniformLocation(progGridTiled, "uEffects");
+
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -111,7 +149,8 @@ void Renderer::initOnce() {
 
 void Renderer::ensureSceneTargets(int viewW, int viewH) {
     if (viewW <= 0 || viewH <= 0) return;
-    if (fboW == viewW && fboH == viewH && sceneFBO) return;
+    const int div = quality.bloomDiv < 1 ? 1 : quality.bloomDiv;
+    if (fboW == viewW && fboH == viewH && bloomDiv == div && sceneFBO) return;
 
 
     if (sceneTex) { glDeleteTextures(1, &sceneTex); sceneTex = 0; }
@@ -122,11 +161,13 @@ void Renderer::ensureSceneTargets(int viewW, int viewH) {
     if (pingFBO[1]) { glDeleteFramebuffers(1, &pingFBO[1]); pingFBO[1] = 0; }
 
     fboW = viewW; fboH = viewH;
+    bloomDiv = div;
+    bloomW = std::max(1, fboW / div); bloomH = std::max(1, fboH / div);
 
-    auto makeColorTex = [&](unsigned int& t) {
+    auto makeColorTex = [&](unsigned int& t, int tw, int th) {
         glGenTextures(1, &t);
         glBindTexture(GL_TEXTURE_2D, t);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, fboW, fboH, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, tw, th, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -134,13 +175,13 @@ void Renderer::ensureSceneTargets(int viewW, int viewH) {
         };
 
     glGenFramebuffers(1, &sceneFBO);
-    makeColorTex(sceneTex);
+    makeColorTex(sceneTex, fboW, fboH);
     glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sceneTex, 0);
 
     for (int i = 0;i < 2;++i) {
         glGenFramebuffers(1, &pingFBO[i]);
-        makeColorTex(pingTex[i]);
+        makeColorTex(pingTex[i], bloomW, bloomH);
         glBindFramebuffer(GL_FRAMEBUFFER, pingFBO[i]);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pingTex[i], 0);
     }
@@ -148,6 +189,131 @@ void Renderer::ensureSceneTargets(int viewW, int viewH) {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void Renderer::ensureCellTarget(int w, int h) {
+    if (cellFBO && cellW == w && cellH == h) return;
+    if (cellTex) { glDeleteTextures(1, &cellTex); cellTex = 0; }
+    if (cellFBO) { glDeleteFramebuffers(1, &cellFBO); cellFBO = 0; }
+    cellW = w; cellH = h;
+    cellValid = false;
+
+    glGenTextures(1, &cellTex);
+    glBindTexture(GL_TEXTURE_2D, cellTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &cellFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, cellFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, cellTex, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Renderer::addPending(int x0, int y0, int rw, int rh) {
+    if (pendX1 < pendX0) { pendX0 = x0; pendY0 = y0; pendX1 = x0 + rw - 1; pendY1 = y0 + rh - 1; return; }
+    pendX0 = std::min(pendX0, x0); pendY0 = std::min(pendY0, y0);
+    pendX1 = std::max(pendX1, x0 + rw - 1); pendY1 = std::max(pendY1, y0 + rh - 1);
+}
+
+// Material -> color lineal solo en lo subido desde el último frame: un fragmento por
+// celda (la textura de índices y la caché tienen las mismas coordenadas)
+void Renderer::resolveCells(int w, int h) {
+    ensureCellTarget(w, h);
+    if (!cellValid) { pendX0 = 0; pendY0 = 0; pendX1 = w - 1; pendY1 = h - 1; }
+    if (pendX1 < pendX0) return;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, cellFBO);
+    glViewport(0, 0, w, h);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(pendX0, pendY0, pendX1 - pendX0 + 1, pendY1 - pendY0 + 1);
+    glDisable(GL_BLEND);
+
+    glUseProgram(progResolve);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glUniform1i(loc_rs_uTex, 0);
+    glUniform2f(loc_rs_uGrid, float(w), float(h));
+    glUniform1i(loc_rs_uEffects, quality.cellEffects ? 1 : 0);
+    drawFullscreen();
+
+    glEnable(GL_BLEND);
+    glDisable(GL_SCISSOR_TEST);
+    cellValid = true;
+    pendX1 = pendX0 - 1;
+}
+
+// Lado por defecto 512; si no caben las capas (GL_MAX_ARRAY_TEXTURE_LAYERS) se dobla.
+// El array se crea una vez por tamaño de rejilla y todas las teselas nacen desfasadas
+void Renderer::ensureTileTarget(int w, int h) {
+    if (tileTex && tileGridW == w && tileGridH == h) return;
+    int t = tileForce > 0 ? tileForce : 512;
+    t = std::min(t, maxTexSize);
+    auto count = [&](int side) { return ((w + side - 1) / side) * ((h + side - 1) / side); };
+    while (count(t) > maxTexLayers && t * 2 <= maxTexSize) t *= 2;
+
+    tileSize = t;
+    tilesX = (w + t - 1) / t; tilesY = (h + t - 1) / t;
+    tileGridW = w; tileGridH = h;
+    tileStale.assign(size_t(tilesX) * size_t(tilesY), 1);
+
+    if (!tileTex) glGenTextures(1, &tileTex);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tileTex);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8UI, t, t, tilesX * tilesY, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+// Mismo encaje que grid_tiled.fs.glsl (escala entera, centrado, fila 0 arriba); con
+// la rejilla más grande que la vista 'off' es negativo y los bordes quedan fuera.
+// Una celda de margen por el redondeo
+void Renderer::updateVisibleTiles(int w, int h, int viewW, int viewH) {
+    const int s = std::max(1, std::min(viewW / w, viewH / h));
+    const float offX = float(viewW - w * s) * 0.5f, offY = float(viewH - h * s) * 0.5f;
+    const int cx0 = std::max(0, int(std::floor(-offX / float(s))) - 1);
+    const int cx1 = std::min(w, int(std::ceil((float(viewW) - offX) / float(s))) + 1);
+    const int cy0 = std::max(0, h - int(std::ceil((float(viewH) - offY) / float(s))) - 1);
+    const int cy1 = std::min(h, h - int(std::floor(-offY / float(s))) + 1);
+    visTX0 = cx0 / tileSize; visTX1 = cx1 > cx0 ? (cx1 - 1) / tileSize + 1 : visTX0;
+    visTY0 = cy0 / tileSize; visTY1 = cy1 > cy0 ? (cy1 - 1) / tileSize + 1 : visTY0;
+}
+
+void Renderer::syncTiles(const std::uint8_t* plane, int w, int h, int viewW, int viewH,
+    int x0, int y0, int rw, int rh) {
+    ensureTileTarget(w, h);
+    updateVisibleTiles(w, h, viewW, viewH);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tileTex);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, w);
+    // Directo desde el plano: cada subida es a lo sumo una tesela
+    auto upload = [&](int tx, int ty, int ax, int ay, int bx, int by) {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, ax - tx * tileSize, ay - ty * tileSize, ty * tilesX + tx,
+            bx - ax, by - ay, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, plane + size_t(ay) * size_t(w) + size_t(ax));
+    };
+    auto visible = [&](int tx, int ty) { return tx >= visTX0 && tx < visTX1 && ty >= visTY0 && ty < visTY1; };
+
+    if (rw > 0 && rh > 0) {
+        for (int ty = y0 / tileSize; ty <= (y0 + rh - 1) / tileSize; ++ty)
+            for (int tx = x0 / tileSize; tx <= (x0 + rw - 1) / tileSize; ++tx) {
+                std::uint8_t& stale = tileStale[size_t(ty) * size_t(tilesX) + size_t(tx)];
+                if (stale) continue;                        // ya se subirá entera
+                if (!visible(tx, ty)) { stale = 1; continue; }
+                upload(tx, ty, std::max(x0, tx * tileSize), std::max(y0, ty * tileSize),
+                    std::min(x0 + rw, (tx + 1) * tileSize), std::min(y0 + rh, (ty + 1) * tileSize));
+            }
+    }
+    for (int ty = visTY0; ty < visTY1; ++ty)
+        for (int tx = visTX0; tx < visTX1; ++tx) {
+            std::uint8_t& stale = tileStale[size_t(ty) * size_t(tilesX) + size_t(tx)];
+            if (!stale) continue;
+            upload(tx, ty, tx * tileSize, ty * tileSize, std::min(w, (tx + 1) * tileSize), std::min(h, (ty + 1) * tileSize));
+            stale = 0;
+        }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
 void Renderer::uploadFullCPU(const std::uint8_t* img, int w, int h) {
     if (!img || w <= 0 || h <= 0) return;
     glBindTexture(GL_TEXTURE_2D, tex);
@@ -157,9 +323,11 @@ void Renderer::uploadFullCPU(const std::uint8_t* img, int w, int h) {
     }
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RED_INTEGER, GL_UNSIGNED_BYTE, img);
     texValid = true;
+    addPending(0, 0, w, h);
 }
 
-void Renderer::uploadRectPBO(const std::uint8_t* src, int rw, int rh, int x0, int y0, int texWNeeded, int texHNeeded) {
+void Renderer::uploadRectPBO(const std::uint8_t* src, int srcStride, int rw, int rh, int x0, int y0,
+    int texWNeeded, int texHNeeded) {
     if (rw <= 0 || rh <= 0) return;
 
     glBindTexture(GL_TEXTURE_2D, tex);
@@ -170,18 +338,22 @@ void Renderer::uploadRectPBO(const std::uint8_t* src, int rw, int rh, int x0, in
 
     const size_t bytes = size_t(rw) * size_t(rh);
     if (pbo[0] == 0 && pbo[1] == 0) glGenBuffers(2, pbo);
-    if (pboCapacity < bytes) {
+    // Del tamaño de la textura entera: ningún dirty-rect posterior obliga a recrearlos
+    const size_t full = size_t(texWNeeded) * size_t(texHNeeded);
+    if (pboCapacity < full) {
         for (int i = 0;i < 2;++i) {
             glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[i]);
-            glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, full, nullptr, GL_STREAM_DRAW);
         }
-        pboCapacity = bytes;
+        pboCapacity = full;
     }
 
+    // Las filas del rect se copian del plano directamente al PBO (sin buffer intermedio)
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[pboIdx]);
-    void* ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
-        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
-    std::memcpy(ptr, src, bytes);
+    auto* ptr = static_cast<std::uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    for (int y = 0; y < rh; ++y)
+        std::memcpy(ptr + size_t(y) * size_t(rw), src + size_t(y) * size_t(srcStride), size_t(rw));
     glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
 
     glPixelStorei(GL_UNPACK_ROW_LENGTH, rw);
@@ -190,6 +362,7 @@ void Renderer::uploadRectPBO(const std::uint8_t* src, int rw, int rh, int x0, in
 
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     pboIdx ^= 1;
+    addPending(x0, y0, rw, rh);
 }
 
 void Renderer::drawFullscreen() {
@@ -197,14 +370,59 @@ void Renderer::drawFullscreen() {
     glDrawArrays(GL_TRIANGLES, 0, 3);
 }
 
+void Renderer::setBloomRegions(const int* xywh, int n) {
+    if (n > kMaxBloomRects) {
+        // Más zonas de las que caben: su envolvente
+        int x0 = xywh[0], y0 = xywh[1], x1 = x0 + xywh[2], y1 = y0 + xywh[3];
+        for (int i = 1; i < n; ++i) {
+            const int* r = xywh + 4 * i;
+            x0 = std::min(x0, r[0]); y0 = std::min(y0, r[1]);
+            x1 = std::max(x1, r[0] + r[2]); y1 = std::max(y1, r[1] + r[3]);
+        }
+        bloomRects[0] = x0; bloomRects[1] = y0; bloomRects[2] = x1 - x0; bloomRects[3] = y1 - y0;
+        bloomRectCount = 1;
+        return;
+    }
+    if (n > 0) std::memcpy(bloomRects, xywh, sizeof(int) * 4 * size_t(n));
+    bloomRectCount = n;
+}
+
+// Mismo encaje que grid_cached.fs.glsl: escala entera s, centrado en off y la fila 0
+// de la rejilla arriba. El margen cubre lo que el blur puede arrastrar (4 texels por
+// pasada y eje) más uno por el filtrado lineal
+int Renderer::bloomScissors(int* out, int w, int h, int viewW, int viewH) const {
+    const int s = std::max(1, std::min(viewW / w, viewH / h));
+    const float offX = float(viewW - w * s) * 0.5f, offY = float(viewH - h * s) * 0.5f;
+    const float kx = float(bloomW) / float(viewW), ky = float(bloomH) / float(viewH);
+    const int pad = 4 * ((quality.bloomPasses + 1) / 2) + 1;
+    int n = 0;
+    for (int i = 0; i < bloomRectCount; ++i) {
+        const int* r = bloomRects + 4 * i;
+        const float px0 = offX + float(r[0] * s), px1 = offX + float((r[0] + r[2]) * s);
+        const float py0 = offY + float((h - r[1] - r[3]) * s), py1 = offY + float((h - r[1]) * s);
+        const int x0 = std::max(0, int(std::floor(px0 * kx)) - pad);
+        const int y0 = std::max(0, int(std::floor(py0 * ky)) - pad);
+        const int x1 = std::min(bloomW, int(std::ceil(px1 * kx)) + pad);
+        const int y1 = std::min(bloomH, int(std::ceil(py1 * ky)) + pad);
+        if (x1 <= x0 || y1 <= y0) continue;
+        out[4 * n] = x0; out[4 * n + 1] = y0; out[4 * n + 2] = x1 - x0; out[4 * n + 3] = y1 - y0;
+        ++n;
+    }
+    return n;
+}
+
 // ------------------------------- DRAW -------------------------------
-void Renderer::drawGrid(const std::vector<uint8_t>& indices, int w, int h, int viewW, int viewH) {
+void Renderer::drawGrid(const std::uint8_t* indices, int w, int h, int viewW, int viewH) {
     ensureGL();
-    if (!indices.empty()) {
-        uploadFullCPU(indices.data(), w, h);
+    tiled = wantTiles(w, h);
+    if (indices) {
+        if (tiled) syncTiles(indices, w, h, viewW, viewH, 0, 0, w, h);
+        else uploadFullCPU(indices, w, h);
     }
 
     ensureSceneTargets(viewW, viewH);
+    const bool cached = cellCache && !tiled;
+    if (cached) resolveCells(w, h);
 
     //Grid → HDR scene
     glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
@@ -212,42 +430,86 @@ void Renderer::drawGrid(const std::vector<uint8_t>& indices, int w, int h, int v
     glClearColor(0.01f, 0.01f, 0.01f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(progGrid);
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glUniform1i(loc_uTex, 0);
-    glUniform2f(loc_uGrid, float(w), float(h));
-    glUniform2f(loc_uView, float(viewW), float(viewH));
+    if (tiled) {
+        glUseProgram(progGridTiled);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, tileTex);
+        glUniform1i(loc_gt_uTiles, 0);
+        glUniform1i(loc_gt_uTileSize, tileSize);
+        glUniform1i(loc_gt_uTilesX, tilesX);
+        glUniform2f(loc_gt_uGrid, float(w), float(h));
+        glUniform2f(loc_gt_uView, float(viewW), float(viewH));
+        glUniform1i(loc_gt_uEffects, quality.cellEffects ? 1 : 0);
+    }
+    else if (cached) {
+        // Solo escalado + disco: el color por celda ya está en cellTex
+        glUseProgram(progGridCached);
+        glBindTexture(GL_TEXTURE_2D, cellTex);
+        glUniform1i(loc_gc_uCells, 0);
+        glUniform2f(loc_gc_uGrid, float(w), float(h));
+        glUniform2f(loc_gc_uView, float(viewW), float(viewH));
+        glUniform1i(loc_gc_uEffects, quality.cellEffects ? 1 : 0);
+    }
+    else {
+        glUseProgram(progGrid);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glUniform1i(loc_uTex, 0);
+        glUniform2f(loc_uGrid, float(w), float(h));
+        glUniform2f(loc_uView, float(viewW), float(viewH));
+        glUniform1i(loc_uEffects, quality.cellEffects ? 1 : 0);
+    }
     drawFullscreen();
 
-    //Bloom
+    //Bloom (a bloomW x bloomH; el filtro lineal hace el down/upsample)
     glDisable(GL_BLEND);
-
-    glUseProgram(progThresh);
-    glUniform1i(loc_th_uScene, 0);
-    glUniform1f(loc_th_uThreshold, 1.0f);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, sceneTex);
-    glBindFramebuffer(GL_FRAMEBUFFER, pingFBO[0]);
-    glViewport(0, 0, viewW, viewH);
-    drawFullscreen();
+    bool horizontal = true;
+    // Con zonas emisivas solo se procesan sus rects de scissor; el resto de los
+    // ping-pong se limpia a negro una vez para que el blur no lea restos de otro frame
+    int scissors[4 * kMaxBloomRects];
+    const int nScissors = bloomRectCount > 0 ? bloomScissors(scissors, w, h, viewW, viewH) : 0;
+    const bool bloom = quality.bloom && bloomRectCount != 0 && (bloomRectCount < 0 || nScissors > 0);
+    auto drawBloomPass = [&]() {
+        if (bloomRectCount < 0) { drawFullscreen(); return; }
+        for (int i = 0; i < nScissors; ++i) {
+            glScissor(scissors[4 * i], scissors[4 * i + 1], scissors[4 * i + 2], scissors[4 * i + 3]);
+            drawFullscreen();
+        }
+        };
+    if (bloom) {
+        if (bloomRectCount > 0) {
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            for (int i = 0; i < 2; ++i) {
+                glBindFramebuffer(GL_FRAMEBUFFER, pingFBO[i]);
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+            glEnable(GL_SCISSOR_TEST);
+        }
+        glUseProgram(progThresh);
+        glUniform1i(loc_th_uScene, 0);
+        glUniform1f(loc_th_uThreshold, 1.0f);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, sceneTex);
+        glBindFramebuffer(GL_FRAMEBUFFER, pingFBO[0]);
+        glViewport(0, 0, bloomW, bloomH);
+        drawBloomPass();
+    }
 
     //Blur
-    bool horizontal = true;
-    int passes = 6;
+    const int passes = bloom ? quality.bloomPasses : 0;
     for (int i = 0;i < passes;++i) {
         glUseProgram(progBlur);
         glUniform1i(loc_bl_uTex, 0);
-        glUniform2f(loc_bl_uTexel, 1.0f / float(viewW), 1.0f / float(viewH));
+        glUniform2f(loc_bl_uTexel, 1.0f / float(bloomW), 1.0f / float(bloomH));
         glUniform1i(loc_bl_uHorizontal, horizontal ? 1 : 0);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, pingTex[horizontal ? 0 : 1]);
 
         glBindFramebuffer(GL_FRAMEBUFFER, pingFBO[horizontal ? 1 : 0]);
-        drawFullscreen();
+        drawBloomPass();
         horizontal = !horizontal;
     }
+    glDisable(GL_SCISSOR_TEST);
 
     //Composite
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -256,7 +518,7 @@ void Renderer::drawGrid(const std::vector<uint8_t>& indices, int w, int h, int v
     glUniform1i(loc_cp_uScene, 0);
     glUniform1i(loc_cp_uBloom, 1);
     glUniform1f(loc_cp_uExposure, 1.0f);
-    glUniform1f(loc_cp_uBloomStrength, 0.7f);
+    glUniform1f(loc_cp_uBloomStrength, bloom ? 0.7f : 0.0f);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, sceneTex);
@@ -275,25 +537,22 @@ void Renderer::draw(const std::vector<Cell>& cells, int w, int h, int viewW, int
         uint8_t* dst = &scratch[size_t(y) * size_t(w)];
         for (int x = 0; x < w; ++x) dst[x] = row[x].m;
     }
-    drawGrid(scratch, w, h, viewW, viewH);
+    drawGrid(scratch.data(), w, h, viewW, viewH);
 }
 
 void Renderer::drawPlane(const std::uint8_t* planeM, int w, int h,
     int viewW, int viewH, int x0, int y0, int rw, int rh) {
     ensureGL();
 
-    if (!texValid || texW != w || texH != h) {
+    if (wantTiles(w, h)) {
+        syncTiles(planeM, w, h, viewW, viewH, x0, y0, rw, rh);
+    }
+    else if (!texValid || texW != w || texH != h) {
         uploadFullCPU(planeM, w, h);
     }
     else if (rw > 0 && rh > 0) {
-        scratchRect.resize(size_t(rw) * size_t(rh));
-        for (int y = 0; y < rh; ++y) {
-            const uint8_t* srcRow = &planeM[size_t(y0 + y) * size_t(w) + size_t(x0)];
-            uint8_t* dstRow = &scratchRect[size_t(y) * size_t(rw)];
-            std::memcpy(dstRow, srcRow, size_t(rw));
-        }
-        uploadRectPBO(scratchRect.data(), rw, rh, x0, y0, w, h);
+        uploadRectPBO(planeM + size_t(y0) * size_t(w) + size_t(x0), w, rw, rh, x0, y0, w, h);
     }
 
-    drawGrid(std::vector<uint8_t>{}, w, h, viewW, viewH);
+    drawGrid(nullptr, w, h, viewW, viewH);
 }
@@ -0,0 +1,40 @@
+#include "scene.h"
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include "engine.h"
+
+void seedRandomScene(Engine& e, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    const Material mats[] = { Material::Sand, Material::Water, Material::Stone, Material::Wood, Material::Fire };
+    std::uniform_int_distribution<int> px(0, e.width() - 1), py(0, e.height() - 1), pr(2, 12), pm(0, 4);
+    int strokes = 8 + int(rng() % 24);
+    for (int s = 0; s < strokes; ++s) e.paint(px(rng), py(rng), mats[pm(rng)], pr(rng));
+    int x, y, rw, rh;
+    e.takeDirtyRect(x, y, rw, rh);
+}
+
+bool loadPythonScene(const char* path, std::vector<std::uint8_t>& out, int& w, int& h) {
+    // EMPTY SAND WATER WOOD FIRE SMOKE del prototipo (fallingSand.py)
+    static const Material pyIds[] = { Material::Empty, Material::Sand, Material::Water,
+                                      Material::Wood, Material::Fire, Material::Smoke };
+    std::ifstream in(path);
+    if (!in) return false;
+    out.clear();
+    w = 0; h = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        int v, n = 0;
+        while (ss >> v) {
+            out.push_back(std::uint8_t(v >= 0 && v < 6 ? pyIds[v] : Material::Empty));
+            ++n;
+        }
+        if (n == 0) continue;
+        if (w == 0) w = n;
+        if (n != w) return false;   // filas de distinta longitud
+        ++h;
+    }
+    return w > 0 && h > 0;
+}
@@ -0,0 +1,92 @@
+#include "shm_publisher.h"
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "engine.h"
+
+ShmSlot* ShmPublisher::slotAt(std::uint64_t frame) const {
+    const std::uint64_t stride = header->slotStride;
+    return reinterpret_cast<ShmSlot*>(base + kShmHeaderBytes + (frame % std::uint64_t(nSlots)) * stride);
+}
+
+bool ShmPublisher::create(const char* name, int gridW, int gridH, int slots) {
+    close();
+    if (gridW <= 0 || gridH <= 0 || slots < 2) return false;
+    shmName = (name[0] == '/') ? name : std::string("/") + name;
+
+    // Siempre un segmento nuevo: uno que quede de un publicador caido (u otro vivo con el
+    // mismo nombre) se desenlaza; sus lectores siguen con su mapeo hasta reabrir. O_EXCL
+    // falla si alguien lo recrea entre medias en vez de compartirlo a medio inicializar
+    shm_unlink(shmName.c_str());
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+    const std::uint64_t stride = shmSlotStride(gridW, gridH);
+    mapBytes = kShmHeaderBytes + size_t(stride) * size_t(slots);
+    struct stat st;
+    if (ftruncate(fd, off_t(mapBytes)) != 0 || fstat(fd, &st) != 0 || std::uint64_t(st.st_size) < mapBytes) {
+        ::close(fd);
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+    void* p = mmap(nullptr, mapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) { shm_unlink(shmName.c_str()); return false; }
+
+    base = static_cast<std::uint8_t*>(p);
+    w = gridW; h = gridH; nSlots = slots;
+    frameCount = 0;
+
+    // La cabecera se rellena antes del magic: un lector que abra a medias lo rechaza
+    header = new (base) ShmHeader{};
+    header->version = kShmVersion;
+    header->width = std::uint32_t(w); header->height = std::uint32_t(h);
+    header->slots = std::uint32_t(slots);
+    header->slotStride = stride;
+    header->latest.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < slots; ++i) {
+        ShmSlot* s = new (base + kShmHeaderBytes + size_t(i) * size_t(stride)) ShmSlot{};
+        s->seq.store(0, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, kShmMagic, sizeof(kShmMagic));
+    return true;
+}
+
+void ShmPublisher::close() {
+    if (!base) return;
+    munmap(base, mapBytes);
+    shm_unlink(shmName.c_str());
+    base = nullptr; header = nullptr; writing = nullptr;
+}
+
+std::uint8_t* ShmPublisher::beginFrame() {
+    if (!header) return nullptr;
+    writing = slotAt(frameCount + 1);
+    const std::uint64_t s = writing->seq.load(std::memory_order_relaxed);
+    writing->seq.store(s + 1, std::memory_order_relaxed);   // impar: en escritura
+    std::atomic_thread_fence(std::memory_order_release);
+    return reinterpret_cast<std::uint8_t*>(writing) + kShmSlotHeaderBytes;
+}
+
+void ShmPublisher::endFrame(std::uint64_t tick, int dx, int dy, int dw, int dh) {
+    if (!writing) return;
+    ++frameCount;
+    writing->frame = frameCount;
+    writing->tick = tick;
+    writing->dirtyX = dx; writing->dirtyY = dy; writing->dirtyW = dw; writing->dirtyH = dh;
+    writing->seq.store(writing->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    header->latest.store(frameCount, std::memory_order_release);
+    writing = nullptr;
+}
+
+void ShmPublisher::publish(const Engine& e) {
+    if (!header || e.width() != w || e.height() != h) return;
+    int x, y, rw, rh;
+    e.peekDirtyRect(x, y, rw, rh);
+    std::uint8_t* dst = beginFrame();
+    std::memcpy(dst, e.planeM(), size_t(w) * size_t(h));
+    endFrame(e.ticks(), x, y, rw, rh);
+}
@@ -0,0 +1,64 @@
+#include "shm_reader.h"
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool ShmReader::open(const char* name) {
+    close();
+    std::string n = (name[0] == '/') ? name : std::string("/") + name;
+    int fd = shm_open(n.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < kShmHeaderBytes) { ::close(fd); return false; }
+    void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    base = static_cast<const std::uint8_t*>(p);
+    mapBytes = size_t(st.st_size);
+    header = reinterpret_cast<const ShmHeader*>(base);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    w = int(header->width); h = int(header->height);
+    nSlots = int(header->slots);
+    stride = header->slotStride;
+    if (std::memcmp(header->magic, kShmMagic, sizeof(kShmMagic)) != 0 || header->version != kShmVersion ||
+        nSlots <= 0 || stride < shmSlotStride(w, h) || kShmHeaderBytes + stride * std::uint64_t(nSlots) > mapBytes) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ShmReader::close() {
+    if (base) munmap(const_cast<std::uint8_t*>(base), mapBytes);
+    base = nullptr; header = nullptr;
+}
+
+std::uint64_t ShmReader::latestFrame() const {
+    return header ? header->latest.load(std::memory_order_acquire) : 0;
+}
+
+bool ShmReader::readLatest(std::vector<std::uint8_t>& out, ShmFrameInfo& info, int retries) const {
+    if (!header) return false;
+    out.resize(size_t(w) * size_t(h));
+    for (int attempt = 0; attempt < retries; ++attempt) {
+        const std::uint64_t f = header->latest.load(std::memory_order_acquire);
+        if (f == 0) return false;
+        const std::uint8_t* slotBase = base + kShmHeaderBytes + (f % std::uint64_t(nSlots)) * stride;
+        const ShmSlot* s = reinterpret_cast<const ShmSlot*>(slotBase);
+
+        const std::uint64_t s1 = s->seq.load(std::memory_order_acquire);
+        if (s1 & 1u) continue;
+        ShmFrameInfo tmp;
+        tmp.frame = s->frame; tmp.tick = s->tick;
+        tmp.dirtyX = s->dirtyX; tmp.dirtyY = s->dirtyY; tmp.dirtyW = s->dirtyW; tmp.dirtyH = s->dirtyH;
+        std::memcpy(out.data(), slotBase + kShmSlotHeaderBytes, out.size());
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t s2 = s->seq.load(std::memory_order_relaxed);
+        if (s1 == s2 && tmp.frame == f) { info = tmp; return true; }
+    }
+    return false;
+}
@@ -0,0 +1,322 @@
+#include "soft_renderer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FS_AVX2_DISPATCH 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define FS_AVX2_ALWAYS 1
+#endif
+
+// ---------------------------- util ----------------------------
+// Mismo hash que grid.fs.glsl (hash2), devuelve los 10 bits bajos
+static std::uint32_t cellHash(std::uint32_t x, std::uint32_t y) {
+    std::uint32_t h = (x * 374761393u) ^ (y * 668265263u);
+    h = (h ^ (h >> 13)) * 1274126177u;
+    h ^= h >> 16;
+    return h & 1023u;
+}
+
+// Igual que post_composite sin bloom: 1-exp(-x), gamma 2.2
+static std::uint8_t tonemap8(float lin) {
+    float c = 1.0f - std::exp(-lin);
+    c = std::pow(std::max(c, 0.0f), 1.0f / 2.2f);
+    return (std::uint8_t)std::lround(std::min(c, 1.0f) * 255.0f);
+}
+
+static std::uint32_t packRGBA(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a = 255) {
+    return std::uint32_t(r) | (std::uint32_t(g) << 8) | (std::uint32_t(b) << 16) | (std::uint32_t(a) << 24);
+}
+
+// ---------------------------- ctor ----------------------------
+SoftRenderer::SoftRenderer(int scale) : s(std::max(1, scale)) {
+    discClass.resize(size_t(s) * size_t(s));
+    for (int j = 0; j < s; ++j)
+        for (int i = 0; i < s; ++i) {
+            // centro del sub-pixel relativo al centro de la celda (como 'p' en el shader)
+            float px = (i + 0.5f) / float(s) - 0.5f, py = (j + 0.5f) / float(s) - 0.5f;
+            float r = std::sqrt(px * px + py * py);
+            float t = std::min(std::max((r - 0.35f) / 0.30f, 0.0f), 1.0f);
+            float alpha = 1.0f - t * t * (3.0f - 2.0f * t);     // 1 - smoothstep
+            std::uint8_t a8 = (std::uint8_t)std::lround(alpha * 255.0f);
+
+            // Pocas coberturas distintas (simetria radial): una lut mezclada por cada una
+            auto it = std::find(discLevels.begin(), discLevels.end(), a8);
+            if (it == discLevels.end()) { discLevels.push_back(a8); it = discLevels.end() - 1; }
+            discClass[size_t(j) * size_t(s) + size_t(i)] = (std::uint8_t)(it - discLevels.begin());
+        }
+    rebuildPalette();
+}
+
+void SoftRenderer::rebuildPalette() {
+    const float clearLin = 0.01f;
+    const std::uint8_t bg = tonemap8(clearLin);
+    background = packRGBA(bg, bg, bg);
+
+    const size_t entries = size_t(256) * kTintLevels;
+    lut.assign(entries, background);
+    discLut.assign(s == 1 ? 0 : entries * discLevels.size(), background);
+    for (int m = 1; m < 256; ++m) {
+        const MatProps& mp = matProps((u8)m);
+        if (mp.name.empty() || mp.a == 0) continue;
+        const float alpha = mp.a / 255.0f;
+        const float emis = std::max(mp.emissive, 0.0f);
+        const float base[3] = { std::pow(mp.r / 255.0f, 2.2f), std::pow(mp.g / 255.0f, 2.2f), std::pow(mp.b / 255.0f, 2.2f) };
+        for (int l = 0; l < kTintLevels; ++l) {
+            const float n = 2.0f * float(l) / float(kTintLevels - 1) - 1.0f;
+            float lin[3];
+            for (int k = 0; k < 3; ++k) lin[k] = std::min(std::max(base[k] * (1.0f + 0.15f * n), 0.0f), 1.0f) * emis;
+            // Blend sobre el clear en lineal (HDR) y despues tonemap, como el blend de GL
+            // sobre la escena: la cobertura del disco multiplica el alpha del material
+            auto shade = [&](float a) {
+                std::uint8_t ch[3];
+                for (int k = 0; k < 3; ++k) ch[k] = tonemap8(lin[k] * a + clearLin * (1.0f - a));
+                return packRGBA(ch[0], ch[1], ch[2]);
+            };
+            const size_t e = size_t(m) * kTintLevels + size_t(l);
+            lut[e] = shade(alpha);
+            if (s == 1) continue;
+            for (size_t k = 0; k < discLevels.size(); ++k)
+                discLut[k * entries + e] = shade(alpha * (discLevels[k] / 255.0f));
+        }
+    }
+}
+
+void SoftRenderer::resize(int w, int h) {
+    gridW = w; gridH = h;
+    fbW = w * s; fbH = h * s;
+    fb.assign(size_t(fbW) * size_t(fbH), background);
+
+    // El shader indexa celdas con y hacia arriba (gl_FragCoord); la fila 0 del plano es la de arriba
+    tint.resize(size_t(w) * size_t(h));
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            std::uint32_t hv = cellHash(std::uint32_t(x), std::uint32_t(h - 1 - y));
+            tint[size_t(y) * size_t(w) + size_t(x)] = (std::uint8_t)((hv * (kTintLevels - 1) + 511u) / 1023u);
+        }
+}
+
+// --------------------------- shading --------------------------
+static void expandRowScalar(const std::uint8_t* m, const std::uint8_t* t, const std::uint32_t* lut,
+    std::uint32_t* dst, int n, int levels) {
+    for (int i = 0; i < n; ++i) dst[i] = lut[size_t(m[i]) * size_t(levels) + t[i]];
+}
+
+#if defined(FS_AVX2_DISPATCH) || defined(FS_AVX2_ALWAYS)
+#if defined(FS_AVX2_DISPATCH)
+__attribute__((target("avx2")))
+#endif
+static void expandRowAVX2(const std::uint8_t* m, const std::uint8_t* t, const std::uint32_t* lut,
+    std::uint32_t* dst, int n, int levels) {
+    const int shift = 6; // kTintLevels == 64
+    (void)levels;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i m32 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(m + i)));
+        __m256i t32 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(t + i)));
+        __m256i idx = _mm256_add_epi32(_mm256_slli_epi32(m32, shift), t32);
+        __m256i px = _mm256_i32gather_epi32((const int*)lut, idx, 4);
+        _mm256_storeu_si256((__m256i*)(dst + i), px);
+    }
+    expandRowScalar(m + i, t + i, lut, dst + i, n - i, 1 << shift);
+}
+#endif
+
+using ExpandFn = void (*)(const std::uint8_t*, const std::uint8_t*, const std::uint32_t*, std::uint32_t*, int, int);
+
+static ExpandFn pickExpand() {
+#if defined(FS_AVX2_ALWAYS)
+    return &expandRowAVX2;
+#elif defined(FS_AVX2_DISPATCH)
+    static const ExpandFn fn = __builtin_cpu_supports("avx2") ? &expandRowAVX2 : &expandRowScalar;
+    return fn;
+#else
+    return &expandRowScalar;
+#endif
+}
+
+void SoftRenderer::shadeRows(const std::uint8_t* planeM, int x0, int y0, int rw, int rh) {
+    static_assert(kTintLevels == 64, "expandRowAVX2 asume 64 niveles");
+    const ExpandFn expand = pickExpand();
+
+    if (s == 1) {
+        for (int y = y0; y < y0 + rh; ++y) {
+            const size_t o = size_t(y) * size_t(gridW) + size_t(x0);
+            expand(planeM + o, tint.data() + o, lut.data(), fb.data() + o, rw, kTintLevels);
+        }
+        return;
+    }
+
+    // Escalado entero: cada sub-pixel lee la lut de su clase de cobertura
+    const size_t entries = lut.size();
+    for (int y = y0; y < y0 + rh; ++y) {
+        const size_t o = size_t(y) * size_t(gridW);
+        for (int j = 0; j < s; ++j) {
+            std::uint32_t* dst = fb.data() + size_t(y * s + j) * size_t(fbW);
+            const std::uint8_t* cls = discClass.data() + size_t(j) * size_t(s);
+            for (int x = x0; x < x0 + rw; ++x) {
+                const size_t key = size_t(planeM[o + size_t(x)]) * kTintLevels + tint[o + size_t(x)];
+                std::uint32_t* px = dst + size_t(x) * size_t(s);
+                for (int i = 0; i < s; ++i) px[i] = discLut[cls[i] * entries + key];
+            }
+        }
+    }
+}
+
+void SoftRenderer::update(const std::uint8_t* planeM, int w, int h, int x0, int y0, int rw, int rh) {
+    if (!planeM || w <= 0 || h <= 0) return;
+    if (w != gridW || h != gridH) {
+        resize(w, h);
+        x0 = 0; y0 = 0; rw = w; rh = h;
+    }
+    x0 = std::max(0, x0); y0 = std::max(0, y0);
+    rw = std::min(rw, w - x0); rh = std::min(rh, h - y0);
+    if (rw <= 0 || rh <= 0) return;
+    shadeRows(planeM, x0, y0, rw, rh);
+}
+
+// ----------------------------- PPM -----------------------------
+bool writePPM(const char* path, const std::uint32_t* rgba, int w, int h) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    std::fprintf(f, "P6\n%d %d\n255\n", w, h);
+    std::vector<std::uint8_t> row(size_t(w) * 3);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            std::uint32_t p = rgba[size_t(y) * size_t(w) + size_t(x)];
+            row[size_t(x) * 3 + 0] = std::uint8_t(p);
+            row[size_t(x) * 3 + 1] = std::uint8_t(p >> 8);
+            row[size_t(x) * 3 + 2] = std::uint8_t(p >> 16);
+        }
+        std::fwrite(row.data(), 1, row.size(), f);
+    }
+    return std::fclose(f) == 0;
+}
+
+// ----------------------------- PNG -----------------------------
+// Sin zlib: deflate con bloques "stored" (sin comprimir), valido para cualquier lector
+static constexpr std::array<std::uint32_t, 256> makeCrcTable() {
+    std::array<std::uint32_t, 256> t{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        t[i] = c;
+    }
+    return t;
+}
+
+// Tabla en tiempo de compilacion: sin estado mutable compartido entre hilos
+static std::uint32_t crc32(const std::uint8_t* p, size_t n, std::uint32_t crc = 0) {
+    static constexpr std::array<std::uint32_t, 256> table = makeCrcTable();
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 255u] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBE32(std::vector<std::uint8_t>& v, std::uint32_t x) {
+    v.push_back(std::uint8_t(x >> 24)); v.push_back(std::uint8_t(x >> 16));
+    v.push_back(std::uint8_t(x >> 8)); v.push_back(std::uint8_t(x));
+}
+
+static void writeChunk(std::FILE* f, const char type[4], const std::vector<std::uint8_t>& data) {
+    std::vector<std::uint8_t> buf;
+    buf.reserve(data.size() + 12);
+    putBE32(buf, std::uint32_t(data.size()));
+    buf.insert(buf.end(), type, type + 4);
+    buf.insert(buf.end(), data.begin(), data.end());
+    putBE32(buf, crc32(buf.data() + 4, data.size() + 4));
+    std::fwrite(buf.data(), 1, buf.size(), f);
+}
+
+bool writePNG(const char* path, const std::uint32_t* rgba, int w, int h) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    static const std::uint8_t sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::fwrite(sig, 1, 8, f);
+
+    std::vector<std::uint8_t> ihdr;
+    putBE32(ihdr, std::uint32_t(w)); putBE32(ihdr, std::uint32_t(h));
+    ihdr.insert(ihdr.end(), { 8, 6, 0, 0, 0 }); // 8 bits, RGBA
+    writeChunk(f, "IHDR", ihdr);
+
+    // Filas con byte de filtro 0 delante
+    const size_t stride = size_t(w) * 4 + 1;
+    std::vector<std::uint8_t> raw(stride * size_t(h));
+    for (int y = 0; y < h; ++y) {
+        raw[size_t(y) * stride] = 0;
+        std::memcpy(&raw[size_t(y) * stride + 1], rgba + size_t(y) * size_t(w), size_t(w) * 4);
+    }
+
+    std::vector<std::uint8_t> z;
+    z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    z.push_back(0x78); z.push_back(0x01);
+    std::uint32_t a = 1, b = 0;
+    for (size_t off = 0;;) {
+        const size_t n = std::min<size_t>(65535, raw.size() - off);
+        const bool last = off + n >= raw.size();
+        z.push_back(last ? 1 : 0);
+        z.push_back(std::uint8_t(n)); z.push_back(std::uint8_t(n >> 8));
+        z.push_back(std::uint8_t(~n)); z.push_back(std::uint8_t(~n >> 8));
+        for (size_t i = 0; i < n; ++i) {
+            const std::uint8_t c = raw[off + i];
+            z.push_back(c);
+            a = (a + c) % 65521u; b = (b + a) % 65521u;
+        }
+        off += n;
+        if (last) break;
+    }
+    putBE32(z, (b << 16) | a);
+    writeChunk(f, "IDAT", z);
+    writeChunk(f, "IEND", {});
+    return std::fclose(f) == 0;
+}
+
+// ----------------------------- Y4M -----------------------------
+bool Y4MWriter::open(const char* path, int width, int height, int fps) {
+    close();
+    f = std::fopen(path, "wb");
+    if (!f) return false;
+    w = width; h = height;
+    std::fprintf(f, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", w, h, fps);
+    const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+    yuv.resize(size_t(w) * size_t(h) + 2 * size_t(cw) * size_t(ch));
+    return true;
+}
+
+bool Y4MWriter::writeFrame(const std::uint32_t* rgba) {
+    if (!f) return false;
+    const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+    std::uint8_t* Y = yuv.data();
+    std::uint8_t* U = Y + size_t(w) * size_t(h);
+    std::uint8_t* V = U + size_t(cw) * size_t(ch);
+
+    // BT.601 rango completo (jpeg), enteros en punto fijo 8.8
+    for (size_t i = 0; i < size_t(w) * size_t(h); ++i) {
+        int r = int(rgba[i] & 255u), g = int((rgba[i] >> 8) & 255u), b = int((rgba[i] >> 16) & 255u);
+        Y[i] = std::uint8_t((77 * r + 150 * g + 29 * b + 128) >> 8);
+    }
+    for (int cy = 0; cy < ch; ++cy)
+        for (int cx = 0; cx < cw; ++cx) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int dy = 0; dy < 2; ++dy)
+                for (int dx = 0; dx < 2; ++dx) {
+                    int x = cx * 2 + dx, y = cy * 2 + dy;
+                    if (x >= w || y >= h) continue;
+                    std::uint32_t p = rgba[size_t(y) * size_t(w) + size_t(x)];
+                    r += int(p & 255u); g += int((p >> 8) & 255u); b += int((p >> 16) & 255u); ++n;
+                }
+            r /= n; g /= n; b /= n;
+            U[size_t(cy) * size_t(cw) + size_t(cx)] = std::uint8_t(std::clamp((-43 * r - 85 * g + 128 * b + 32768) >> 8, 0, 255));
+            V[size_t(cy) * size_t(cw) + size_t(cx)] = std::uint8_t(std::clamp((128 * r - 107 * g - 21 * b + 32768) >> 8, 0, 255));
+        }
+    std::fputs("FRAME\n", f);
+    return std::fwrite(yuv.data(), 1, yuv.size(), f) == yuv.size();
+}
+
+void Y4MWriter::close() {
+    if (f) { std::fclose(f); f = nullptr; }
+}
@@ -0,0 +1,167 @@
+#include "spatial_query.h"
+#include <algorithm>
+#include "engine.h"
+
+SpatialQuery::SpatialQuery(const Engine& e) : engine(e) {}
+
+const MaterialSummary& SpatialQuery::summary() const {
+    static const MaterialSummary none;
+    const MaterialSummary* s = engine.summary();
+    return s ? *s : none;   // sin resumen: 0 chunks, todas las consultas vacias
+}
+
+// Recorta el rect a la rejilla; false si queda vacio. Salida en [x0,x1) x [y0,y1)
+static bool clipRect(const Engine& e, int x, int y, int rw, int rh, int& x0, int& y0, int& x1, int& y1) {
+    x0 = std::max(0, x); y0 = std::max(0, y);
+    x1 = std::min(e.width(), x + rw); y1 = std::min(e.height(), y + rh);
+    return x0 < x1 && y0 < y1;
+}
+
+const SpatialQuery::SAT& SpatialQuery::sat(int cx, int cy, std::uint8_t m) const {
+    const MaterialSummary& s = summary();
+    const std::uint32_t key = (std::uint32_t(cy * s.chunksX() + cx) << 8) | m;
+    const std::uint32_t version = s.at(cx, cy).version;
+    SAT& t = satCache[key];
+    if (t.version == version && version != 0) return t;
+
+    // Reconstruccion perezosa: solo este chunk y este material
+    constexpr int S = kSummaryChunk + 1;
+    const std::uint8_t* plane = engine.planeM();
+    const int W = engine.width(), H = engine.height();
+    const int bx = cx << kSummaryShift, by = cy << kSummaryShift;
+    std::fill(t.sum, t.sum + S, std::uint16_t(0));
+    for (int ly = 0; ly < kSummaryChunk; ++ly) {
+        const int y = by + ly;
+        std::uint16_t row = 0;
+        t.sum[(ly + 1) * S] = 0;
+        for (int lx = 0; lx < kSummaryChunk; ++lx) {
+            const int x = bx + lx;
+            if (x < W && y < H && plane[size_t(y) * size_t(W) + size_t(x)] == m) ++row;
+            t.sum[(ly + 1) * S + lx + 1] = std::uint16_t(t.sum[ly * S + lx + 1] + row);
+        }
+    }
+    t.version = version;
+    return t;
+}
+
+int SpatialQuery::countInChunk(int cx, int cy, int x0, int y0, int x1, int y1, std::uint8_t m) const {
+    if (useSAT) {
+        constexpr int S = kSummaryChunk + 1;
+        const SAT& t = sat(cx, cy, m);
+        const int bx = cx << kSummaryShift, by = cy << kSummaryShift;
+        const int lx0 = x0 - bx, ly0 = y0 - by, lx1 = x1 - bx, ly1 = y1 - by;
+        return int(t.sum[ly1 * S + lx1]) - int(t.sum[ly0 * S + lx1]) - int(t.sum[ly1 * S + lx0]) + int(t.sum[ly0 * S + lx0]);
+    }
+    const std::uint8_t* plane = engine.planeM();
+    const size_t W = size_t(engine.width());
+    int n = 0;
+    for (int y = y0; y < y1; ++y) {
+        const std::uint8_t* row = plane + size_t(y) * W;
+        for (int x = x0; x < x1; ++x) n += row[x] == m;
+    }
+    return n;
+}
+
+int SpatialQuery::count(int x, int y, int rw, int rh, std::uint8_t m) const {
+    const MaterialSummary& s = summary();
+    int x0, y0, x1, y1;
+    if (s.chunksX() == 0 || !clipRect(engine, x, y, rw, rh, x0, y0, x1, y1)) return 0;
+
+    int n = 0;
+    for (int cy = y0 >> kSummaryShift; cy <= (y1 - 1) >> kSummaryShift; ++cy)
+        for (int cx = x0 >> kSummaryShift; cx <= (x1 - 1) >> kSummaryShift; ++cx) {
+            const MaterialSummary::Chunk& c = s.at(cx, cy);
+            if (c.counts[m] == 0) continue;
+            const int bx0 = cx << kSummaryShift, by0 = cy << kSummaryShift;
+            const int bx1 = std::min(engine.width(), bx0 + kSummaryChunk), by1 = std::min(engine.height(), by0 + kSummaryChunk);
+            const int ix0 = std::max(x0, bx0), iy0 = std::max(y0, by0);
+            const int ix1 = std::min(x1, bx1), iy1 = std::min(y1, by1);
+            if (ix0 == bx0 && iy0 == by0 && ix1 == bx1 && iy1 == by1) n += c.counts[m];
+            else n += countInChunk(cx, cy, ix0, iy0, ix1, iy1, m);
+        }
+    return n;
+}
+
+int SpatialQuery::count(int x, int y, int rw, int rh, const MaterialMask& mats) const {
+    int n = 0;
+    for (int m = 0; m < 256; ++m)
+        if (mats.test(std::uint8_t(m))) n += count(x, y, rw, rh, std::uint8_t(m));
+    return n;
+}
+
+bool SpatialQuery::anyInChunk(int x0, int y0, int x1, int y1, const MaterialMask& mats) const {
+    const std::uint8_t* plane = engine.planeM();
+    const size_t W = size_t(engine.width());
+    for (int y = y0; y < y1; ++y) {
+        const std::uint8_t* row = plane + size_t(y) * W;
+        for (int x = x0; x < x1; ++x)
+            if (mats.test(row[x])) return true;
+    }
+    return false;
+}
+
+bool SpatialQuery::anyOf(int x, int y, int rw, int rh, const MaterialMask& mats) const {
+    const MaterialSummary& s = summary();
+    int x0, y0, x1, y1;
+    if (s.chunksX() == 0 || !clipRect(engine, x, y, rw, rh, x0, y0, x1, y1)) return false;
+
+    for (int cy = y0 >> kSummaryShift; cy <= (y1 - 1) >> kSummaryShift; ++cy)
+        for (int cx = x0 >> kSummaryShift; cx <= (x1 - 1) >> kSummaryShift; ++cx) {
+            if (!s.at(cx, cy).present.intersects(mats)) continue;
+            const int bx0 = cx << kSummaryShift, by0 = cy << kSummaryShift;
+            const int bx1 = std::min(engine.width(), bx0 + kSummaryChunk), by1 = std::min(engine.height(), by0 + kSummaryChunk);
+            const int ix0 = std::max(x0, bx0), iy0 = std::max(y0, by0);
+            const int ix1 = std::min(x1, bx1), iy1 = std::min(y1, by1);
+            if (ix0 == bx0 && iy0 == by0 && ix1 == bx1 && iy1 == by1) return true;
+            if (anyInChunk(ix0, iy0, ix1, iy1, mats)) return true;
+        }
+    return false;
+}
+
+bool SpatialQuery::anyWithin(int cx, int cy, int r, const MaterialMask& mats) const {
+    int nx, ny;
+    return nearest(cx, cy, mats, r, nx, ny);
+}
+
+bool SpatialQuery::nearest(int x, int y, const MaterialMask& mats, int maxRadius, int& outX, int& outY) const {
+    const MaterialSummary& s = summary();
+    if (s.chunksX() == 0 || maxRadius < 0) return false;
+    const int W = engine.width(), H = engine.height();
+
+    // Candidatos: chunks con alguno de los materiales, por distancia minima al punto
+    struct Cand { long long d2; int cx, cy; };
+    std::vector<Cand> cands;
+    const long long r2 = (long long)maxRadius * maxRadius;
+    const int cx0 = std::max(0, (x - maxRadius) >> kSummaryShift), cx1 = std::min(s.chunksX() - 1, (x + maxRadius) >> kSummaryShift);
+    const int cy0 = std::max(0, (y - maxRadius) >> kSummaryShift), cy1 = std::min(s.chunksY() - 1, (y + maxRadius) >> kSummaryShift);
+    for (int cy = cy0; cy <= cy1; ++cy)
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            if (!s.at(cx, cy).present.intersects(mats)) continue;
+            const int bx0 = cx << kSummaryShift, by0 = cy << kSummaryShift;
+            const long long dx = x < bx0 ? bx0 - x : std::max(0, x - std::min(W - 1, bx0 + kSummaryChunk - 1));
+            const long long dy = y < by0 ? by0 - y : std::max(0, y - std::min(H - 1, by0 + kSummaryChunk - 1));
+            const long long d2 = dx * dx + dy * dy;
+            if (d2 <= r2) cands.push_back({ d2, cx, cy });
+        }
+    std::sort(cands.begin(), cands.end(), [](const Cand& a, const Cand& b) { return a.d2 < b.d2; });
+
+    const std::uint8_t* plane = engine.planeM();
+    long long best = r2 + 1;
+    for (const Cand& c : cands) {
+        if (c.d2 >= best) break;    // ningun chunk restante puede mejorar
+        const int bx0 = c.cx << kSummaryShift, by0 = c.cy << kSummaryShift;
+        const int bx1 = std::min(W, bx0 + kSummaryChunk), by1 = std::min(H, by0 + kSummaryChunk);
+        for (int yy = by0; yy < by1; ++yy) {
+            const long long dy = yy - y;
+            if (dy * dy >= best) continue;
+            const std::uint8_t* row = plane + size_t(yy) * size_t(W);
+            for (int xx = bx0; xx < bx1; ++xx) {
+                if (!mats.test(row[xx])) continue;
+                const long long dx = xx - x;
+                const long long d2 = dx * dx + dy * dy;
+                if (d2 < best) { best = d2; outX = xx; outY = yy; }
+            }
+        }
+    }
+    return best <= r2;
+}
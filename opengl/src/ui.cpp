@@ -1,5 +1,7 @@
 #include "ui.h"
 #include <glad/gl.h>
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include "material.h"
 #include "engine.h"
@@ -40,7 +42,8 @@ void UI::init() {
 	glGenBuffers(1, &vbo);
 	glBindVertexArray(vao);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, 4 * 1024 * 1024, nullptr, GL_DYNAMIC_DRAW); 
+	glBufferData(GL_ARRAY_BUFFER, kVboBytes, nullptr, GL_DYNAMIC_DRAW); 
+	verts.reserve(kVboBytes / sizeof(Vertex));
 
 
 	glEnableVertexAttribArray(0);
@@ -116,12 +119,12 @@ void UI::flush() {
 	glUniform2f(loc_uView, (float)vw, (float)vh);
 	glBindVertexArray(vao);
 	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, verts.size() * sizeof(Vertex), verts.data());
+	glBufferSubData(GL_ARRAY_BUFFER, 0, std::min(verts.size() * sizeof(Vertex), kVboBytes), verts.data());
 
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glDrawArrays(GL_TRIANGLES, 0, (GLint)verts.size());
+	glDrawArrays(GL_TRIANGLES, 0, (GLint)std::min(verts.size(), kVboBytes / sizeof(Vertex)));
 }
 
 
@@ -133,6 +136,8 @@ void UI::rect(float x, float y, float w, float h, uint32_t c) {
 	{x, y, c}, {x + w, y, c}, {x + w, y + h, c},
 	{x, y, c}, {x + w, y + h, c}, {x, y + h, c},
 	};
+	// Lo que no cabe en el VBO no se dibuja: el vector no crece mas alla de lo reservado
+	if (verts.size() + 6 > verts.capacity()) return;
 	verts.insert(verts.end(), v, v + 6);
 }
 
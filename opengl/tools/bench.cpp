@@ -0,0 +1,468 @@
+// Benchmark headless: muchos mundos independientes en el pool de BatchRunner.
+//   FallingSandBench [--worlds N] [--threads T] [--ticks K] [--size WxH] [--seed S] [--verify 1]
+//                    [--mode scan|margolus] [--layout linear|tiled|morton] [--lod WxH]
+//                    [--alloc-check N] [--perf 1] [--history-check N] [--record out.fsr]
+//                    [--query-check N]
+// --layout elige el orden de las Cell en memoria (ver GridLayout); el resultado es el
+// mismo en los tres, solo cambia el coste. La referencia de --verify es siempre Linear.
+// --alloc-check N avanza un mundo como el bucle de frames (tick, dirty-rect, cola de
+// audio) y falla si alguno de los N ticks tras el calentamiento reserva memoria;
+// necesita -DFALLINGSAND_ALLOC_COUNT=ON.
+// --perf avanza un mundo en el hilo principal y mide cada fase de tick() (sync, step)
+// con contadores hardware (perf_event_open, Linux): ciclos, instrucciones, fallos de
+// L1d/LLC/saltos/dTLB por tick y por celda, junto al tiempo. Sin contadores (otro SO,
+// contenedor, perf_event_paranoid) da solo los tiempos.
+// --history-check N pinta N checkpoints con la simulacion corriendo entre ellos y
+// luego deshace y rehace con ticks entre cada salto: cada undo/redo debe devolver el
+// hash del checkpoint, y desde ahi los mismos ticks deben dar el mismo hash que la
+// primera vez (estado de simulacion y de LOD incluidos).
+// --query-check N compara N consultas aleatorias de SpatialQuery (count, anyOf,
+// anyWithin, nearest) con un recorrido del plano, con y sin SAT: rects que cortan
+// chunks del borde o salen de la rejilla, radios que cruzan chunks. Con --size que no
+// sea multiplo de 32 entran los chunks parciales del borde.
+// --record graba cada uno de los --ticks ticks de un mundo en un .fsr (un registro por
+// tick con cambios, keyframe cada 240); FallingSandReplay --verify 1 lo comprueba.
+// --lod activa el LOD temporal con una vista de WxH celdas centrada en el mundo: lo
+// de fuera (y lo quieto de dentro) se actualiza a menor ritmo.
+// --verify avanza el batch tick a tick contra una ejecucion serie de referencia y
+// compara stateHash() en cada tick; en la primera divergencia lista los chunks distintos.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "alloc_count.h"
+#include "batch.h"
+#include "history.h"
+#include "material.h"
+#include "perf_counters.h"
+#include "recorder.h"
+#include "scene.h"
+#include "spatial_query.h"
+
+struct BenchArgs {
+    int worlds = 64;
+    int threads = 0;
+    int ticks = 600;
+    int gridW = 320, gridH = 180;
+    std::uint32_t seed = 1;
+    bool verify = false;
+    SimMode mode = SimMode::Scan;
+    GridLayout layout = GridLayout::Linear;
+    int lodW = 0, lodH = 0;     // 0 = sin LOD
+    int allocCheck = 0;
+    bool perf = false;
+    int historyCheck = 0;
+    const char* recordPath = nullptr;
+    int queryCheck = 0;
+};
+
+static bool parseArgs(int argc, char** argv, BenchArgs& a) {
+    for (int i = 1; i < argc; ++i) {
+        const char* k = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!v) return false;
+        if (!std::strcmp(k, "--worlds")) a.worlds = std::atoi(v);
+        else if (!std::strcmp(k, "--threads")) a.threads = std::atoi(v);
+        else if (!std::strcmp(k, "--ticks")) a.ticks = std::atoi(v);
+        else if (!std::strcmp(k, "--seed")) a.seed = (std::uint32_t)std::strtoul(v, nullptr, 10);
+        else if (!std::strcmp(k, "--verify")) a.verify = std::atoi(v) != 0;
+        else if (!std::strcmp(k, "--alloc-check")) a.allocCheck = std::atoi(v);
+        else if (!std::strcmp(k, "--perf")) a.perf = std::atoi(v) != 0;
+        else if (!std::strcmp(k, "--history-check")) a.historyCheck = std::atoi(v);
+        else if (!std::strcmp(k, "--record")) a.recordPath = v;
+        else if (!std::strcmp(k, "--query-check")) a.queryCheck = std::atoi(v);
+        else if (!std::strcmp(k, "--mode")) {
+            if (!std::strcmp(v, "scan")) a.mode = SimMode::Scan;
+            else if (!std::strcmp(v, "margolus")) a.mode = SimMode::Margolus;
+            else return false;
+        }
+        else if (!std::strcmp(k, "--layout")) {
+            if (!std::strcmp(v, "linear")) a.layout = GridLayout::Linear;
+            else if (!std::strcmp(v, "tiled")) a.layout = GridLayout::Tiled;
+            else if (!std::strcmp(v, "morton")) a.layout = GridLayout::Morton;
+            else return false;
+        }
+        else if (!std::strcmp(k, "--size")) {
+            if (std::sscanf(v, "%dx%d", &a.gridW, &a.gridH) != 2) return false;
+        }
+        else if (!std::strcmp(k, "--lod")) {
+            if (std::sscanf(v, "%dx%d", &a.lodW, &a.lodH) != 2) return false;
+        }
+        else return false;
+        ++i;
+    }
+    return a.worlds > 0 && a.ticks > 0 && a.gridW > 0 && a.gridH > 0;
+}
+
+static std::uint32_t sceneSeed(const BenchArgs& a, int i) { return a.seed * 7919u + std::uint32_t(i); }
+
+static void applyLod(Engine& e, const BenchArgs& a) {
+    if (a.lodW <= 0) return;
+    e.enableLod(true);
+    if (LodScheduler* lod = e.lod()) {
+        const int x0 = (a.gridW - a.lodW) / 2, y0 = (a.gridH - a.lodH) / 2;
+        lod->setView(x0, y0, x0 + a.lodW, y0 + a.lodH);
+    }
+}
+
+// Determinismo: el batch (N hilos, robo de trabajo) debe dar el mismo hash que un
+// mundo avanzado en serie, tick a tick
+static int verify(BatchRunner& batch, const BenchArgs& a) {
+    std::vector<std::unique_ptr<Engine>> ref;
+    for (int i = 0; i < batch.size(); ++i) {
+        ref.push_back(std::make_unique<Engine>(a.gridW, a.gridH, BatchRunner::worldSeed(a.seed, i), a.mode));
+        ref.back()->audioEnabled = false;
+        seedRandomScene(*ref.back(), sceneSeed(a, i));
+        applyLod(*ref.back(), a);
+        batch.world(i).enableChunkHashes(true);
+        ref.back()->enableChunkHashes(true);
+    }
+    for (int t = 1; t <= a.ticks; ++t) {
+        batch.step(1);
+        for (int i = 0; i < batch.size(); ++i) {
+            Engine& r = *ref[size_t(i)];
+            r.tick();
+            const Engine& b = batch.world(i);
+            if (b.stateHash() == r.stateHash()) continue;
+
+            std::printf("DIVERGENCIA mundo %d tick %d: %016llx != %016llx (referencia)\n", i, t,
+                (unsigned long long)b.stateHash(), (unsigned long long)r.stateHash());
+            for (int cy = 0; cy < r.hashChunksY(); ++cy)
+                for (int cx = 0; cx < r.hashChunksX(); ++cx)
+                    if (b.chunkHash(cx, cy) != r.chunkHash(cx, cy))
+                        std::printf("  chunk (%d,%d): celdas [%d..%d]x[%d..%d]\n", cx, cy,
+                            cx * kHashChunk, cx * kHashChunk + kHashChunk - 1, cy * kHashChunk, cy * kHashChunk + kHashChunk - 1);
+            return 1;
+        }
+    }
+    std::printf("verify ok: %d mundos x %d ticks, threads=%d\n", batch.size(), a.ticks, batch.threadCount());
+    return 0;
+}
+
+// Regimen estable sin reservas: lo mismo que hace el bucle de frames con el motor
+static int allocCheck(const BenchArgs& a) {
+    if (!allocCountEnabled()) {
+        std::fprintf(stderr, "alloc-check: compilado sin FALLINGSAND_ALLOC_COUNT\n");
+        return 2;
+    }
+    const int warmup = 120;
+    Engine e(a.gridW, a.gridH, a.seed, a.mode, a.layout);
+    seedRandomScene(e, sceneSeed(a, 0));
+    applyLod(e, a);
+    std::vector<AudioEvent> events;
+    events.reserve(256);
+    int bad = 0;
+    for (int t = 0; t < warmup + a.allocCheck; ++t) {
+        const std::uint64_t n0 = allocCount(), b0 = allocBytes();
+        e.tick();
+        int x, y, rw, rh;
+        e.takeDirtyRect(x, y, rw, rh);
+        events.clear();
+        e.takeAudioEvents(events);
+        const std::uint64_t n = allocCount() - n0;
+        if (t >= warmup && n > 0 && bad++ < 10)
+            std::printf("alloc-check: tick %d: %llu reservas, %llu bytes\n", t, (unsigned long long)n,
+                (unsigned long long)(allocBytes() - b0));
+    }
+    std::printf("alloc-check: %d de %d ticks con reservas tras %d de calentamiento\n", bad, a.allocCheck, warmup);
+    return bad > 0 ? 1 : 0;
+}
+
+// Undo/redo con la simulacion en marcha: H[k] es el hash en el checkpoint k, L[k] el
+// estado del LOD ahi y T[k] el hash tras 'gap' ticks desde ahi
+static int historyCheck(const BenchArgs& a) {
+    const int gap = 20, n = a.historyCheck;
+    Engine e(a.gridW, a.gridH, a.seed, a.mode, a.layout);
+    e.audioEnabled = false;
+    seedRandomScene(e, sceneSeed(a, 0));
+    applyLod(e, a);
+    History hist;
+    hist.attach(e);
+
+    std::vector<std::uint64_t> H(size_t(n) + 1), T(size_t(n) + 1);
+    std::vector<LodScheduler::State> L(size_t(n) + 2);
+    auto saveLod = [&](size_t k) { if (const LodScheduler* lod = e.lod()) lod->save(L[k]); };
+    H[0] = e.stateHash();
+    saveLod(0);
+    for (int k = 1; k <= n; ++k) {
+        for (int t = 0; t < gap; ++t) e.tick();
+        T[size_t(k - 1)] = e.stateHash();
+        const int r = 2 + k % 5;
+        e.paint(r + int(std::uint32_t(k) * 2654435761u % std::uint32_t(a.gridW - 2 * r)), r + (k * 37) % (a.gridH - 2 * r),
+            k % 2 ? Material::Sand : Material::Water, r);
+        hist.checkpoint();
+        H[size_t(k)] = e.stateHash();
+        saveLod(size_t(k));
+    }
+    for (int t = 0; t < gap; ++t) e.tick();
+    T[size_t(n)] = e.stateHash();
+    saveLod(size_t(n) + 1);
+
+    int bad = 0;
+    auto expect = [&](const char* what, int k, std::uint64_t want) {
+        if (e.stateHash() != want && bad++ < 10)
+            std::printf("history-check: %s %d: %016llx != %016llx\n", what, k,
+                (unsigned long long)e.stateHash(), (unsigned long long)want);
+    };
+    auto expectLod = [&](const char* what, int k, size_t l) {
+        const LodScheduler* lod = e.lod();
+        if (!lod) return;
+        LodScheduler::State st;
+        lod->save(st);
+        if ((st.hit != L[l].hit || st.quiet != L[l].quiet) && bad++ < 10)
+            std::printf("history-check: %s %d: estado del LOD distinto\n", what, k);
+    };
+    auto run = [&](int k) {
+        for (int t = 0; t < gap; ++t) e.tick();
+        expect("ticks tras checkpoint", k, T[size_t(k)]);
+    };
+    // El primer undo guarda los ticks desde el ultimo checkpoint como un paso mas y
+    // vuelve a H[n]; el ultimo redo lo recupera
+    for (int k = n; k >= 0; --k) {
+        if (!hist.undo()) { std::printf("history-check: undo a %d fallo\n", k); return 1; }
+        expect("undo a", k, H[size_t(k)]);
+        expectLod("undo a", k, size_t(k));
+        run(k);
+    }
+    for (int k = 1; k <= n; ++k) {
+        if (!hist.redo()) { std::printf("history-check: redo a %d fallo\n", k); return 1; }
+        expect("redo a", k, H[size_t(k)]);
+        expectLod("redo a", k, size_t(k));
+        run(k);
+    }
+    if (!hist.redo() || hist.canRedo()) { std::printf("history-check: redo final fallo\n"); return 1; }
+    expect("redo final a", n, T[size_t(n)]);
+    expectLod("redo final a", n, size_t(n) + 1);
+    std::printf("history-check: %d checkpoints, %d discrepancias%s\n", n, bad, e.lod() ? " (lod)" : "");
+    return bad > 0 ? 1 : 0;
+}
+
+// SpatialQuery contra fuerza bruta sobre planeM(); unos ticks entre tandas para que
+// cambien los resumenes y se reconstruyan las SAT
+static int queryCheck(const BenchArgs& a) {
+    Engine e(a.gridW, a.gridH, a.seed, a.mode, a.layout);
+    e.audioEnabled = false;
+    seedRandomScene(e, sceneSeed(a, 0));
+    e.enableSummary(true);
+    SpatialQuery q(e);
+    const int W = a.gridW, H = a.gridH;
+
+    std::uint64_t rs = a.seed * 0x9E3779B97F4A7C15ull + 1;
+    auto rnd = [&](int lo, int hi) {     // [lo, hi]
+        rs ^= rs << 13; rs ^= rs >> 7; rs ^= rs << 17;
+        return lo + int(rs % std::uint64_t(hi - lo + 1));
+    };
+    // Bordes de rect: a veces alineados a chunk, a veces fuera de la rejilla
+    auto coord = [&](int n) {
+        return rnd(0, 3) == 0 ? std::min(n, rnd(0, n / kSummaryChunk) * kSummaryChunk) : rnd(-kSummaryChunk, n + kSummaryChunk);
+    };
+
+    int bad = 0, done = 0;
+    auto fail = [&](const char* what, bool sat, int x, int y, int rw, int rh, long long got, long long want) {
+        if (bad++ < 10)
+            std::printf("query-check: %s (sat=%d) en (%d,%d %dx%d): %lld != %lld\n", what, sat, x, y, rw, rh, got, want);
+    };
+    while (done < a.queryCheck) {
+        for (int t = 0; t < 3; ++t) e.tick();
+        const std::uint8_t* plane = e.planeM();     // front cambia de buffer en cada tick
+        for (int k = 0; k < 64 && done < a.queryCheck; ++k, ++done) {
+            MaterialMask mats;
+            const int nm = rnd(1, 2);
+            for (int i = 0; i < nm; ++i) mats.set(std::uint8_t(rnd(0, 7)));   // 7: sin celdas
+
+            const int x0 = coord(W), y0 = coord(H);
+            const int x1 = std::max(x0, coord(W)), y1 = std::max(y0, coord(H));
+            long long want = 0;
+            for (int y = std::max(0, y0); y < std::min(H, y1); ++y)
+                for (int x = std::max(0, x0); x < std::min(W, x1); ++x) want += mats.test(plane[size_t(y) * size_t(W) + size_t(x)]);
+
+            const int px = rnd(-8, W + 8), py = rnd(-8, H + 8), r = rnd(0, 3 * kSummaryChunk);
+            long long best = -1;
+            for (int y = std::max(0, py - r); y <= std::min(H - 1, py + r); ++y)
+                for (int x = std::max(0, px - r); x <= std::min(W - 1, px + r); ++x) {
+                    if (!mats.test(plane[size_t(y) * size_t(W) + size_t(x)])) continue;
+                    const long long d2 = (long long)(x - px) * (x - px) + (long long)(y - py) * (y - py);
+                    if (d2 <= (long long)r * r && (best < 0 || d2 < best)) best = d2;
+                }
+
+            for (int sat = 0; sat < 2; ++sat) {
+                q.useSAT = sat != 0;
+                const long long got = q.count(x0, y0, x1 - x0, y1 - y0, mats);
+                if (got != want) fail("count", q.useSAT, x0, y0, x1 - x0, y1 - y0, got, want);
+                if (q.anyOf(x0, y0, x1 - x0, y1 - y0, mats) != (want > 0))
+                    fail("anyOf", q.useSAT, x0, y0, x1 - x0, y1 - y0, !(want > 0), want > 0);
+
+                int nx = -1, ny = -1;
+                const bool found = q.nearest(px, py, mats, r, nx, ny);
+                const long long d2 = found ? (long long)(nx - px) * (nx - px) + (long long)(ny - py) * (ny - py) : -1;
+                if (found && !(nx >= 0 && nx < W && ny >= 0 && ny < H && mats.test(plane[size_t(ny) * size_t(W) + size_t(nx)])))
+                    fail("nearest: celda sin el material", q.useSAT, px, py, r, r, nx, ny);
+                else if (d2 != best) fail("nearest d2", q.useSAT, px, py, r, r, d2, best);
+                if (q.anyWithin(px, py, r, mats) != (best >= 0)) fail("anyWithin", q.useSAT, px, py, r, r, best < 0, best >= 0);
+            }
+        }
+    }
+    std::printf("query-check: %d consultas x 2 (sat on/off) en %dx%d, %d discrepancias\n", done, W, H, bad);
+    return bad > 0 ? 1 : 0;
+}
+
+// Un mundo grabado tick a tick, como la ventana con la grabacion activa
+static int recordRun(const BenchArgs& a) {
+    Engine e(a.gridW, a.gridH, a.seed, a.mode, a.layout);
+    e.audioEnabled = false;
+    seedRandomScene(e, sceneSeed(a, 0));
+    applyLod(e, a);
+    DeltaRecorder rec;
+    if (!rec.open(a.recordPath, a.gridW, a.gridH)) {
+        std::fprintf(stderr, "record: no se pudo abrir %s\n", a.recordPath);
+        return 1;
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < a.ticks; ++t) {
+        e.tick();
+        rec.capture(e);
+        int x, y, rw, rh;
+        e.takeDirtyRect(x, y, rw, rh);
+    }
+    rec.close();
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::printf("record: %d ticks -> %llu registros, %.1f KB codificados, %llu descartados, %.3f s\n", a.ticks,
+        (unsigned long long)rec.records(), rec.bytesEncoded() / 1024.0, (unsigned long long)rec.dropped(), s);
+    return rec.dropped() > 0 ? 1 : 0;
+}
+
+// Contadores y tiempo de cada fase de tick(), acumulados por separado
+struct PhaseProbe : TickProbe {
+    static constexpr int kPhases = 2;
+    const PerfCounters& pc;
+    PerfCounters::Snapshot at;
+    PerfCounters::Totals totals[kPhases];
+    double seconds[kPhases] = {};
+    std::chrono::steady_clock::time_point t0;
+
+    explicit PhaseProbe(const PerfCounters& c) : pc(c) {}
+    void begin(TickPhase) override {
+        pc.read(at);
+        t0 = std::chrono::steady_clock::now();
+    }
+    void end(TickPhase p) override {
+        const auto t1 = std::chrono::steady_clock::now();
+        PerfCounters::Snapshot s;
+        pc.read(s);
+        totals[int(p)].add(at, s);
+        seconds[int(p)] += std::chrono::duration<double>(t1 - t0).count();
+    }
+};
+
+static int perfRun(const BenchArgs& a) {
+    const int warmup = 60;
+    Engine e(a.gridW, a.gridH, a.seed, a.mode, a.layout);
+    e.audioEnabled = false;
+    seedRandomScene(e, sceneSeed(a, 0));
+    applyLod(e, a);
+    for (int t = 0; t < warmup; ++t) e.tick();
+
+    PerfCounters pc;
+    const bool hw = pc.open();
+    PhaseProbe probe(pc);
+    e.probe = &probe;
+    for (int t = 0; t < a.ticks; ++t) e.tick();
+    e.probe = nullptr;
+
+    static const char* layoutNames[] = { "linear", "tiled", "morton" };
+    std::printf("perf: 1 mundo %dx%d, %d ticks tras %d de calentamiento, mode=%s layout=%s%s\n", a.gridW, a.gridH,
+        a.ticks, warmup, a.mode == SimMode::Margolus ? "margolus" : "scan", layoutNames[int(a.layout)],
+        a.lodW > 0 ? " lod" : "");
+    if (!hw) std::printf("perf: sin contadores hardware (%s); solo tiempos\n", pc.error());
+
+    // Columnas: cada fase y el total, por tick y por celda
+    const double ticks = double(a.ticks), cells = double(a.gridW) * double(a.gridH);
+    static const char* phaseNames[PhaseProbe::kPhases] = { "sync", "step" };
+    const int shown = a.mode == SimMode::Margolus ? 1 : 0;     // Margolus no tiene sync
+    std::printf("%-14s", "");
+    for (int p = shown; p <= PhaseProbe::kPhases; ++p) {
+        const char* n = p < PhaseProbe::kPhases ? phaseNames[p] : "total";
+        std::printf(" %12s/tick %11s/celda", n, n);
+    }
+    std::printf("\n");
+    auto row = [&](const char* label, auto get) {
+        std::printf("%-14s", label);
+        double total = 0.0;
+        for (int p = shown; p <= PhaseProbe::kPhases; ++p) {
+            const double v = p < PhaseProbe::kPhases ? get(p) : total;
+            total += v;
+            std::printf(" %17.1f %17.3f", v / ticks, v / (ticks * cells));
+        }
+        std::printf("\n");
+    };
+    row("ns", [&](int p) { return probe.seconds[p] * 1e9; });
+    for (int ev = 0; ev < PerfCounters::kEvents; ++ev) {
+        if (!pc.has(ev)) { if (hw) std::printf("%-14s n/d\n", PerfCounters::name(ev)); continue; }
+        row(PerfCounters::name(ev), [&](int p) { return probe.totals[p].value(ev); });
+    }
+    if (pc.has(PerfCounters::Cycles) && pc.has(PerfCounters::Instructions)) {
+        std::printf("%-14s", "IPC");
+        double cyc = 0.0, ins = 0.0;
+        for (int p = shown; p <= PhaseProbe::kPhases; ++p) {
+            double c = cyc, i = ins;
+            if (p < PhaseProbe::kPhases) {
+                c = probe.totals[p].value(PerfCounters::Cycles); i = probe.totals[p].value(PerfCounters::Instructions);
+                cyc += c; ins += i;
+            }
+            std::printf(" %17.2f %17s", c > 0.0 ? i / c : 0.0, "");
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    BenchArgs a;
+    if (!parseArgs(argc, argv, a)) {
+        std::fprintf(stderr, "uso: %s [--worlds N] [--threads T] [--ticks K] [--size WxH] [--seed S] [--verify 1] [--mode scan|margolus]\n"
+            "       [--layout linear|tiled|morton] [--lod WxH] [--alloc-check N] [--perf 1] [--history-check N]\n"
+            "       [--record out.fsr] [--query-check N]\n", argv[0]);
+        return 2;
+    }
+    loadMaterialFile(MATERIAL_DIR "/default.mat");
+    if (a.allocCheck > 0) return allocCheck(a);
+    if (a.perf) return perfRun(a);
+    if (a.historyCheck > 0) return historyCheck(a);
+    if (a.recordPath) return recordRun(a);
+    if (a.queryCheck > 0) return queryCheck(a);
+
+    BatchRunner batch(a.worlds, a.gridW, a.gridH, a.threads, a.seed, a.mode, a.layout);
+    for (int i = 0; i < batch.size(); ++i) {
+        seedRandomScene(batch.world(i), sceneSeed(a, i));
+        applyLod(batch.world(i), a);
+    }
+
+    if (a.verify) return verify(batch, a);
+
+    auto t0 = std::chrono::steady_clock::now();
+    batch.step(a.ticks);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    double minS = 1e30, maxS = 0.0, sumS = 0.0;
+    std::uint64_t dirty = 0;
+    for (int i = 0; i < batch.size(); ++i) {
+        const WorldStats& st = batch.stats(i);
+        minS = std::min(minS, st.seconds); maxS = std::max(maxS, st.seconds); sumS += st.seconds;
+        dirty += st.dirtyCells;
+    }
+
+    const double totalTicks = double(a.worlds) * double(a.ticks);
+    const double cells = double(a.gridW) * double(a.gridH);
+    static const char* layoutNames[] = { "linear", "tiled", "morton" };
+    std::printf("worlds=%d threads=%d ticks=%d grid=%dx%d mode=%s layout=%s\n", a.worlds, batch.threadCount(), a.ticks,
+        a.gridW, a.gridH, a.mode == SimMode::Margolus ? "margolus" : "scan", layoutNames[int(a.layout)]);
+    if (a.lodW > 0) std::printf("lod: vista %dx%d centrada\n", a.lodW, a.lodH);
+    std::printf("wall %.3f s | %.0f ticks/s | %.1f Mcells/s\n", wall, totalTicks / wall, totalTicks * cells / wall * 1e-6);
+    std::printf("per world: min %.3f ms  mean %.3f ms  max %.3f ms  (sum %.3f s, utilizacion %.0f%%)\n",
+        minS * 1e3, sumS / a.worlds * 1e3, maxS * 1e3, sumS, 100.0 * sumS / (wall * batch.threadCount()));
+    std::printf("dirty cells/tick (media): %.1f\n", double(dirty) / totalTicks);
+    return 0;
+}
@@ -0,0 +1,79 @@
+// Render headless: simula una escena y la vuelca con SoftRenderer (sin GPU).
+//   FallingSandRender [--ticks K] [--size WxH] [--scale S] [--seed N] [--mode scan|margolus]
+//                     [--y4m video.y4m] [--png final.png] [--ppm final.ppm]
+//                     [--scene python/saved/x.txt]   escena del prototipo, centrada
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "engine.h"
+#include "material.h"
+#include "scene.h"
+#include "soft_renderer.h"
+
+int main(int argc, char** argv) {
+    int ticks = 600, gridW = 320, gridH = 180, scale = 1;
+    std::uint32_t seed = 1;
+    const char* y4mPath = nullptr;
+    const char* pngPath = nullptr;
+    const char* ppmPath = nullptr;
+    const char* scenePath = nullptr;
+    SimMode mode = SimMode::Scan;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* k = argv[i];
+        const char* v = argv[i + 1];
+        if (!std::strcmp(k, "--ticks")) ticks = std::atoi(v);
+        else if (!std::strcmp(k, "--scale")) scale = std::atoi(v);
+        else if (!std::strcmp(k, "--seed")) seed = (std::uint32_t)std::strtoul(v, nullptr, 10);
+        else if (!std::strcmp(k, "--size")) std::sscanf(v, "%dx%d", &gridW, &gridH);
+        else if (!std::strcmp(k, "--y4m")) y4mPath = v;
+        else if (!std::strcmp(k, "--png")) pngPath = v;
+        else if (!std::strcmp(k, "--ppm")) ppmPath = v;
+        else if (!std::strcmp(k, "--scene")) scenePath = v;
+        else if (!std::strcmp(k, "--mode") && !std::strcmp(v, "scan")) mode = SimMode::Scan;
+        else if (!std::strcmp(k, "--mode") && !std::strcmp(v, "margolus")) mode = SimMode::Margolus;
+        else { std::fprintf(stderr, "opcion desconocida: %s\n", k); return 2; }
+    }
+
+    loadMaterialFile(MATERIAL_DIR "/default.mat");
+    Engine engine(gridW, gridH, seed, mode);
+    engine.audioEnabled = false;
+    if (scenePath) {
+        std::vector<std::uint8_t> scene;
+        int sw, sh;
+        if (!loadPythonScene(scenePath, scene, sw, sh)) { std::fprintf(stderr, "no se pudo leer %s\n", scenePath); return 1; }
+        engine.stamp((gridW - sw) / 2, (gridH - sh) / 2, sw, sh, scene.data(), (std::uint8_t)Material::Empty);
+    }
+    else seedRandomScene(engine, seed);
+
+    SoftRenderer sr(scale);
+    sr.updateFull(engine.planeM(), gridW, gridH);
+
+    Y4MWriter video;
+    if (y4mPath && !video.open(y4mPath, sr.width(), sr.height(), 120)) {
+        std::fprintf(stderr, "no se pudo abrir %s\n", y4mPath);
+        return 1;
+    }
+
+    double renderSec = 0.0;
+    for (int t = 0; t < ticks; ++t) {
+        engine.tick();
+        int x, y, rw, rh;
+        if (engine.takeDirtyRect(x, y, rw, rh)) {
+            auto t0 = std::chrono::steady_clock::now();
+            sr.update(engine.planeM(), gridW, gridH, x, y, rw, rh);
+            renderSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+        if (y4mPath) video.writeFrame(sr.pixels());
+    }
+    video.close();
+
+    if (pngPath && !writePNG(pngPath, sr.pixels(), sr.width(), sr.height())) std::fprintf(stderr, "fallo escribiendo %s\n", pngPath);
+    if (ppmPath && !writePPM(ppmPath, sr.pixels(), sr.width(), sr.height())) std::fprintf(stderr, "fallo escribiendo %s\n", ppmPath);
+
+    std::printf("%d frames %dx%d: render %.3f ms total, %.0f frames/s\n",
+        ticks, sr.width(), sr.height(), renderSec * 1e3, renderSec > 0.0 ? ticks / renderSec : 0.0);
+    return 0;
+}
@@ -0,0 +1,55 @@
+// Lector de ejemplo del anillo en memoria compartida: cuenta celdas por material.
+//   FallingSandShmCounts [nombre] [--frames N] [--interval ms]
+// El productor (FallingSand con FALLINGSAND_SHM=nombre) no espera a este proceso.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "material.h"
+#include "shm_reader.h"
+
+int main(int argc, char** argv) {
+    const char* name = "fallingsand";
+    int frames = 0;          // 0 = sin limite
+    int intervalMs = 500;
+    int i = 1;
+    if (argc > 1 && argv[1][0] != '-') name = argv[i++];
+    for (; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "--frames")) frames = std::atoi(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--interval")) intervalMs = std::atoi(argv[i + 1]);
+    }
+
+    loadMaterialFile(MATERIAL_DIR "/default.mat");
+    ensureMaterials();
+
+    ShmReader reader;
+    while (!reader.open(name)) {
+        std::fprintf(stderr, "esperando a /dev/shm/%s ...\n", name);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    std::printf("%s: %dx%d\n", name, reader.width(), reader.height());
+
+    std::vector<std::uint8_t> plane;
+    ShmFrameInfo info;
+    std::uint64_t lastFrame = 0;
+    for (int n = 0; frames == 0 || n < frames;) {
+        if (reader.latestFrame() != lastFrame && reader.readLatest(plane, info)) {
+            lastFrame = info.frame;
+            std::size_t counts[256] = {};
+            for (std::uint8_t m : plane) ++counts[m];
+            std::printf("frame %llu tick %llu:", (unsigned long long)info.frame, (unsigned long long)info.tick);
+            for (int m = 0; m < 256; ++m)
+                if (counts[m] && m != (int)Material::Empty) {
+                    std::string_view n = matProps((u8)m).name;
+                    std::printf(" %.*s=%zu", (int)n.size(), n.data(), counts[m]);
+                }
+            std::printf("\n");
+            std::fflush(stdout);
+            ++n;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+    }
+    return 0;
+}
@@ -0,0 +1,264 @@
+"""Prototipo Python (sandsim.py) contra el motor C++ (libfallingsand) sobre las mismas escenas.
+
+Uso:
+    python bench_compare.py [escenas.txt ...] [--ticks N] [--seed S] [--json out.json]
+
+Sin escenas usa python/saved/*.txt. Cada implementacion corre en su propio
+subproceso (asi el pico de memoria es solo suyo) y el informe junta, por escena:
+ticks/s, latencia por tick (p50/p90/p99/max), pico de memoria y la similitud del
+estado final entre las dos. "rss +pico" es lo que crecio el pico de RSS del
+subproceso durante la simulacion; "heap pico" (solo Python) sale de tracemalloc.
+Si libfallingsand no esta compilada, solo se mide Python.
+
+Los ids del prototipo se traducen a materiales del motor por nombre, igual que
+loadPythonScene() en opengl/src/scene.cpp; al comparar se hace la traduccion inversa.
+"""
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+import time
+import tracemalloc
+
+try:
+    import resource
+except ImportError:  # Windows: sin ru_maxrss, solo tracemalloc
+    resource = None
+
+import sandsim
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SAVED = os.path.join(os.path.dirname(HERE), "saved")
+
+
+def peak_rss_kb():
+    if resource is None:
+        return None
+    kb = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return kb // 1024 if sys.platform == "darwin" else kb   # macOS da bytes
+
+
+def percentiles(samples, ps=(50, 90, 99)):
+    s = sorted(samples)
+    if not s:
+        return {}
+    out = {"p%d" % p: s[min(len(s) - 1, int(len(s) * p / 100.0))] for p in ps}
+    out["max"] = s[-1]
+    out["mean"] = sum(s) / len(s)
+    return out
+
+
+# ------------------------------- workers -------------------------------
+def run_python(scene, ticks, seed):
+    cols, rows = sandsim.scene_size(scene)
+    tracemalloc.start()
+    rss0 = peak_rss_kb()
+    sim = sandsim.SandSim(cols, rows, seed)
+    sim.load_txt(scene)
+
+    lat = []
+    t0 = time.perf_counter()
+    for _ in range(ticks):
+        a = time.perf_counter()
+        sim.update()
+        lat.append(time.perf_counter() - a)
+    wall = time.perf_counter() - t0
+    _, heap_peak = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+    rss1 = peak_rss_kb()
+    return {
+        "impl": "python", "width": cols, "height": rows, "wall": wall, "latency": lat,
+        "heap_peak_kb": heap_peak // 1024,
+        "rss_peak_kb": rss1, "rss_growth_kb": (rss1 - rss0) if rss0 is not None else None,
+        "plane": list(sim.plane()),
+    }
+
+
+def run_native(scene, ticks, seed):
+    import fallingsand_native as fsn
+
+    cols, rows = sandsim.scene_size(scene)
+    to_engine = {pid: fsn.material_id(name) for pid, name in sandsim.NAMES.items()}
+    # Plano del motor fila a fila, sin pasar por SandSim: ru_maxrss es un maximo
+    # historico y el pico de sus listas taparia lo que crece el motor
+    empty = to_engine[sandsim.EMPTY]
+    src = bytearray([empty]) * (cols * rows)
+    for y, row in enumerate(sandsim.iter_rows(scene)):
+        for x, val in enumerate(row):
+            src[y * cols + x] = to_engine.get(int(val), empty)
+
+    rss0 = peak_rss_kb()
+    w = fsn.World(cols, rows, seed)
+    w.set_plane(src)
+
+    lat = []
+    t0 = time.perf_counter()
+    for _ in range(ticks):
+        a = time.perf_counter()
+        w.step(1)
+        lat.append(time.perf_counter() - a)
+    wall = time.perf_counter() - t0
+    rss1 = peak_rss_kb()
+
+    # Vuelta a ids del prototipo; lo que no existe alli (Stone...) queda como -1
+    from_engine = {mid: pid for pid, mid in to_engine.items()}
+    plane = [from_engine.get(v, -1) for v in bytes(w.get_plane(bytearray(cols * rows)))]
+    w.close()
+    return {
+        "impl": "native", "width": cols, "height": rows, "wall": wall, "latency": lat,
+        "heap_peak_kb": None,
+        "rss_peak_kb": rss1, "rss_growth_kb": (rss1 - rss0) if rss0 is not None else None,
+        "plane": plane,
+    }
+
+
+def worker_main(args):
+    fn = run_python if args.worker == "python" else run_native
+    json.dump(fn(args.scene, args.ticks, args.seed), sys.stdout)
+
+
+# ------------------------------ comparacion ------------------------------
+def similarity(a, b):
+    """Metricas del estado final, 1.0 = identico.
+
+    cells:     fraccion de celdas con el mismo material
+    occupancy: IoU de las celdas no vacias (donde hay algo, sea lo que sea)
+    histogram: solape de los conteos por material (1 - L1/2 normalizado)
+    blocks:    solape de la densidad por material en bloques de 8x8, tolera que
+               los granos acaben en celdas vecinas
+    """
+    w, h = a["width"], a["height"]
+    pa, pb = a["plane"], b["plane"]
+    n = len(pa)
+    same = sum(1 for x, y in zip(pa, pb) if x == y)
+    occ_a = [v != sandsim.EMPTY for v in pa]
+    occ_b = [v != sandsim.EMPTY for v in pb]
+    inter = sum(1 for x, y in zip(occ_a, occ_b) if x and y)
+    union = sum(1 for x, y in zip(occ_a, occ_b) if x or y)
+
+    def hist(p):
+        d = {}
+        for v in p:
+            d[v] = d.get(v, 0) + 1
+        return d
+    ha, hb = hist(pa), hist(pb)
+    l1 = sum(abs(ha.get(k, 0) - hb.get(k, 0)) for k in set(ha) | set(hb))
+
+    B = 8
+    bx, by = (w + B - 1) // B, (h + B - 1) // B
+
+    def blocks(p):
+        d = {}
+        for y in range(h):
+            row = y * w
+            for x in range(w):
+                v = p[row + x]
+                if v != sandsim.EMPTY:
+                    k = (v, (y // B) * bx + x // B)
+                    d[k] = d.get(k, 0) + 1
+        return d
+    ba, bb = blocks(pa), blocks(pb)
+    diff = sum(abs(ba.get(k, 0) - bb.get(k, 0)) for k in set(ba) | set(bb))
+    mass = sum(ba.values()) + sum(bb.values())
+
+    return {
+        "cells": same / n if n else 1.0,
+        "occupancy": inter / union if union else 1.0,
+        "histogram": 1.0 - l1 / (2.0 * n) if n else 1.0,
+        "blocks": 1.0 - diff / mass if mass else 1.0,
+        "counts": {impl["impl"]: {sandsim.NAMES.get(k, "otro"): c for k, c in sorted(hist(impl["plane"]).items())
+                                  if k != sandsim.EMPTY} for impl in (a, b)},
+    }
+
+
+def run_worker(impl, scene, ticks, seed):
+    cmd = [sys.executable, os.path.abspath(__file__), "--worker", impl,
+           "--scene", scene, "--ticks", str(ticks), "--seed", str(seed)]
+    p = subprocess.run(cmd, capture_output=True, text=True, cwd=HERE)
+    if p.returncode != 0:
+        last = p.stderr.strip().splitlines()[-1:] or ["?"]
+        return None, last[0]
+    return json.loads(p.stdout), None
+
+
+def summarize(r, ticks):
+    lat = percentiles([s * 1e3 for s in r["latency"]])
+    return {
+        "ticks_per_s": ticks / r["wall"] if r["wall"] > 0 else float("inf"),
+        "latency_ms": lat,
+        "heap_peak_kb": r["heap_peak_kb"],
+        "rss_peak_kb": r["rss_peak_kb"],
+        "rss_growth_kb": r["rss_growth_kb"],
+    }
+
+
+def fmt_kb(v):
+    return "-" if v is None else ("%.1f MB" % (v / 1024.0))
+
+
+def print_report(report):
+    print("ticks=%d seed=%d" % (report["ticks"], report["seed"]))
+    for sc in report["scenes"]:
+        print("\n== %s (%dx%d)" % (sc["scene"], sc["width"], sc["height"]))
+        print("  %-7s %12s %9s %9s %9s %9s %12s %12s" %
+              ("impl", "ticks/s", "p50 ms", "p90 ms", "p99 ms", "max ms", "rss +pico", "heap pico"))
+        for impl in ("python", "native"):
+            s = sc.get(impl)
+            if s is None:
+                print("  %-7s  no disponible: %s" % (impl, sc.get(impl + "_error", "?")))
+                continue
+            l = s["latency_ms"]
+            print("  %-7s %12.1f %9.3f %9.3f %9.3f %9.3f %12s %12s" %
+                  (impl, s["ticks_per_s"], l["p50"], l["p90"], l["p99"], l["max"],
+                   fmt_kb(s["rss_growth_kb"]), fmt_kb(s["heap_peak_kb"])))
+        if "speedup" in sc:
+            print("  native/python: x%.2f ticks/s" % sc["speedup"])
+        if "similarity" in sc:
+            m = sc["similarity"]
+            print("  similitud final: celdas %.3f  ocupacion %.3f  histograma %.3f  bloques8 %.3f" %
+                  (m["cells"], m["occupancy"], m["histogram"], m["blocks"]))
+            for impl, counts in m["counts"].items():
+                print("    %-7s %s" % (impl, "  ".join("%s=%d" % kv for kv in counts.items())))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("scenes", nargs="*")
+    ap.add_argument("--ticks", type=int, default=300)
+    ap.add_argument("--seed", type=int, default=1)
+    ap.add_argument("--json", help="guarda el informe completo")
+    ap.add_argument("--worker", choices=["python", "native"], help=argparse.SUPPRESS)
+    ap.add_argument("--scene", help=argparse.SUPPRESS)
+    args = ap.parse_args()
+    if args.worker:
+        return worker_main(args)
+
+    scenes = args.scenes or sorted(glob.glob(os.path.join(SAVED, "*.txt")))
+    report = {"ticks": args.ticks, "seed": args.seed, "scenes": []}
+    for scene in scenes:
+        scene = os.path.abspath(scene)
+        w, h = sandsim.scene_size(scene)
+        entry = {"scene": os.path.basename(scene), "width": w, "height": h}
+        results = {}
+        for impl in ("python", "native"):
+            r, err = run_worker(impl, scene, args.ticks, args.seed)
+            if r is None:
+                entry[impl + "_error"] = err
+                continue
+            results[impl] = r
+            entry[impl] = summarize(r, args.ticks)
+        if len(results) == 2:
+            entry["speedup"] = entry["native"]["ticks_per_s"] / entry["python"]["ticks_per_s"]
+            entry["similarity"] = similarity(results["python"], results["native"])
+        report["scenes"].append(entry)
+
+    print_report(report)
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,8 +1,8 @@
 import pygame
 import pygame_gui
-import random
 import tkinter as tk
 from tkinter import filedialog
+from sandsim import SandSim, SAND, WATER, WOOD, FIRE, SMOKE
 
 # VENTANA Y CELDAS
 WIDTH, HEIGHT = 800, 600
@@ -18,20 +18,8 @@ COLOR_WOOD = (101, 67, 33)
 COLOR_FIRE = (255, 69, 0)
 COLOR_SMOKE = (105, 105, 105)
 
-# TIPOS DE PARTICULAS
-EMPTY = 0
-SAND = 1
-WATER = 2
-WOOD = 3
-FIRE = 4
-SMOKE = 5
-
-# PARTICULAS ACTIVAS
-active_sand = set()
-active_water = set()
-active_wood = set()
-active_fire = {}
-active_smoke = set()
+# SIMULACION (sin pygame, ver sandsim.py)
+sim = SandSim(COLS, ROWS)
 
 # PYGAME
 pygame.init()
@@ -63,17 +51,10 @@ def save_grid_txt():
     if not file_path:
         return
 
-    with open(file_path, "w") as f:
-        for y in range(ROWS):
-            line = []
-            for x in range(COLS):
-                line.append(str(grid[x][y]))
-            f.write(" ".join(line) + "\n")
+    sim.save_txt(file_path)
     print(f"Grid guardado en {file_path}")
 
 def load_grid_txt():
-    global grid, active_sand, active_water, active_wood, active_fire, active_smoke
-
     root = tk.Tk()
     root.withdraw()
     file_path = filedialog.askopenfilename(
@@ -83,154 +64,29 @@ def load_grid_txt():
     if not file_path:
         return
 
-    with open(file_path, "r") as f:
-        lines = f.readlines()
-
-    for y, line in enumerate(lines):
-        for x, val in enumerate(line.strip().split()):
-            grid[x][y] = int(val)
-
-    active_sand.clear(); active_water.clear(); active_wood.clear(); active_fire.clear(); active_smoke.clear()
-    for x in range(COLS):
-        for y in range(ROWS):
-            p = grid[x][y]
-            if p == SAND: active_sand.add((x, y))
-            elif p == WATER: active_water.add((x, y))
-            elif p == WOOD: active_wood.add((x, y))
-            elif p == FIRE: active_fire[(x, y)] = random.randint(30,100)
-            elif p == SMOKE: active_smoke.add((x, y))
+    sim.load_txt(file_path)
 
     print(f"Grid cargado desde {file_path}")
 
 
-# GRID
-grid = [[EMPTY for _ in range(ROWS)] for _ in range(COLS)]
-
 def draw():
     screen.fill(COLOR_BG)
 
-    for x,y in active_sand:
+    for x,y in sim.active_sand:
         pygame.draw.rect(screen, COLOR_SAND, (x*CELL_SIZE, y*CELL_SIZE, CELL_SIZE, CELL_SIZE))
 
-    for x,y in active_water:
+    for x,y in sim.active_water:
         pygame.draw.rect(screen, COLOR_WATER, (x*CELL_SIZE, y*CELL_SIZE, CELL_SIZE, CELL_SIZE))
 
-    for x,y in active_wood:
+    for x,y in sim.active_wood:
         pygame.draw.rect(screen, COLOR_WOOD, (x*CELL_SIZE, y*CELL_SIZE, CELL_SIZE, CELL_SIZE))
 
-    for x,y in active_fire:
+    for x,y in sim.active_fire:
         pygame.draw.rect(screen, COLOR_FIRE, (x*CELL_SIZE, y*CELL_SIZE, CELL_SIZE, CELL_SIZE))
 
-    for x,y in active_smoke:
+    for x,y in sim.active_smoke:
         pygame.draw.rect(screen, COLOR_SMOKE, (x*CELL_SIZE, y*CELL_SIZE, CELL_SIZE, CELL_SIZE))
 
-def in_bounds(x, y):
-    return 0 <= x < COLS and 0 <= y < ROWS
-
-def swap_particles(x1, y1, x2, y2):
-    grid[x1][y1], grid[x2][y2] = grid[x2][y2], grid[x1][y1]
-    for s in [active_sand, active_water, active_smoke, active_wood]:
-        if (x1,y1) in s:
-            s.discard((x1,y1)); s.add((x2,y2))
-        elif (x2,y2) in s:
-            s.discard((x2,y2)); s.add((x1,y1))
-    if (x1,y1) in active_fire:
-        active_fire[(x2,y2)] = active_fire.pop((x1,y1))
-    elif (x2,y2) in active_fire:
-        active_fire[(x1,y1)] = active_fire.pop((x2,y2))
-
-def update():
-    
-# --- Arena ---
-    for x, y in list(active_sand):
-        if not in_bounds(x, y): continue
-        below = (x, y+1)
-        if in_bounds(*below) and (grid[below[0]][below[1]] in [EMPTY, WATER]):
-            swap_particles(x, y, *below)
-        else:
-            dx = random.choice([-1,1])
-            diag = (x+dx, y+1)
-            if in_bounds(*diag) and grid[diag[0]][diag[1]] in [EMPTY, WATER]:
-                swap_particles(x, y, *diag)
-
-    # --- Agua ---
-    for x, y in list(active_water):
-        if not in_bounds(x, y): continue
-        below = (x, y+1)
-        if in_bounds(*below) and grid[below[0]][below[1]] == EMPTY:
-            swap_particles(x, y, *below)
-        else:
-            dx = random.choice([-1,1])
-            side = (x+dx, y)
-            if in_bounds(*side) and grid[side[0]][side[1]] == EMPTY:
-                swap_particles(x, y, *side)
-
-    # --- Fuego ---
-    for x, y in list(active_fire):
-        if not in_bounds(x, y): continue
-        # Quemar madera adyacente
-        for dx, dy in [(-1,0),(1,0),(0,-1),(0,1),(1,1),(-1,-1),(-1,1),(1,-1)]:
-            nx, ny = x+dx, y+dy
-            if in_bounds(nx, ny) and grid[nx][ny] == WOOD:
-                add_particle(nx, ny, FIRE)
-        # Vida útil
-        active_fire[(x,y)] -= 1
-        if active_fire[(x,y)] <= 0 or random.random() < 0.02:
-            remove_particle(x, y)
-            above = (x, y-1)
-            if in_bounds(*above) and grid[above[0]][above[1]] == EMPTY:
-                add_particle(*above, SMOKE)
-
-    # --- Humo ---
-    for x, y in list(active_smoke):
-        if not in_bounds(x, y): continue
-        above = (x, y-1)
-        if in_bounds(*above) and grid[above[0]][above[1]] == EMPTY:
-            swap_particles(x, y, *above)
-        else:
-            if random.random() < 0.01:
-                remove_particle(x, y)
-            else:
-                dx = random.choice([-1,1])
-                side = (x+dx, y)
-                if in_bounds(*side) and grid[side[0]][side[1]] == EMPTY:
-                    swap_particles(x, y, *side)
-
-
-
-def add_particle_area(x, y, p_type, size=2):
-    for dx in range(-size, size+1):
-        for dy in range(-size, size+1):
-            if dx*dx + dy*dy <= size*size:
-                add_particle(x+dx, y+dy, p_type)
-
-
-def add_particle(x, y, p_type):
-    if not in_bounds(x, y):
-        return;
-
-    remove_particle(x,y)
-    grid[x][y] = p_type
-    if p_type == SAND:
-        active_sand.add((x, y))
-    elif p_type == WATER:
-        active_water.add((x, y))
-    elif p_type == FIRE:
-        active_fire[(x, y)] = random.randint(30, 100)  # vida útil en frames
-    elif p_type == SMOKE:
-        active_smoke.add((x, y))
-    elif p_type == WOOD:
-        active_wood.add((x,y))
-
-def remove_particle(x, y):
-    p = grid[x][y]
-    grid[x][y] = EMPTY
-    if p == SAND: active_sand.discard((x, y))
-    elif p == WATER: active_water.discard((x, y))
-    elif p == FIRE: active_fire.pop((x, y), None)
-    elif p == SMOKE: active_smoke.discard((x, y))
-    elif p == WOOD: active_wood.discard((x,y))
-
 def main():
     running = True
     current_particle = SAND
@@ -269,7 +125,7 @@ def main():
         if mouse_pressed[0]:
             mx, my = pygame.mouse.get_pos()
             gx, gy = mx // CELL_SIZE, my // CELL_SIZE
-            add_particle_area(gx, gy, current_particle, MOUSE_AREA)
+            sim.add_particle_area(gx, gy, current_particle, MOUSE_AREA)
 
 
         KEYS_PRESSED = pygame.key.get_pressed()
@@ -281,7 +137,7 @@ def main():
         
 
         
-        update()
+        sim.update()
         draw()
         
         manager.update(clock.tick(GAME_SPEED)/1000.0)
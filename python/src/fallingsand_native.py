@@ -0,0 +1,232 @@
+"""Envoltorio ctypes de libfallingsand (el motor C++ de opengl/).
+
+Uso:
+    from fallingsand_native import World, load_materials, material_id
+    w = World(320, 180, seed=1)
+    w.paint(160, 20, material_id("Sand"), 10)
+    w.step(1000)                  # 1000 ticks en una sola llamada nativa
+    plane = w.plane_view()        # vista sin copia (numpy si esta disponible)
+
+La libreria se busca en FALLINGSAND_LIB, luego junto a este fichero y en
+opengl/build*/; si no, en las rutas del sistema.
+"""
+import ctypes
+import glob
+import os
+import sys
+
+try:
+    import numpy as np
+except ImportError:  # numpy es opcional: sin el se usan memoryview/bytearray
+    np = None
+
+API_VERSION = 1
+
+
+class Stats(ctypes.Structure):
+    _fields_ = [
+        ("ticks", ctypes.c_uint64),
+        ("dirty_cells", ctypes.c_uint64),
+        ("quiet_ticks", ctypes.c_uint64),
+        ("seconds", ctypes.c_double),
+        ("counts", ctypes.c_uint32 * 256),
+    ]
+
+
+def _lib_names():
+    if sys.platform.startswith("win"):
+        return ["fallingsand.dll", "libfallingsand.dll"]
+    if sys.platform == "darwin":
+        return ["libfallingsand.dylib"]
+    return ["libfallingsand.so", "libfallingsand.so.1"]
+
+
+def _find_library():
+    env = os.environ.get("FALLINGSAND_LIB")
+    if env:
+        return env
+    here = os.path.dirname(os.path.abspath(__file__))
+    repo = os.path.dirname(os.path.dirname(here))
+    dirs = [here] + sorted(glob.glob(os.path.join(repo, "opengl", "build*"))) \
+        + sorted(glob.glob(os.path.join(repo, "opengl", "build*", "*")))
+    for d in dirs:
+        for name in _lib_names():
+            path = os.path.join(d, name)
+            if os.path.isfile(path):
+                return path
+    return _lib_names()[0]
+
+
+def _load():
+    lib = ctypes.CDLL(_find_library())
+    P = ctypes.c_void_p
+    u8p = ctypes.POINTER(ctypes.c_uint8)
+    ip = ctypes.POINTER(ctypes.c_int)
+    sig = {
+        "fs_api_version": (ctypes.c_int, []),
+        "fs_load_materials": (ctypes.c_int, [ctypes.c_char_p]),
+        "fs_material_id": (ctypes.c_int, [ctypes.c_char_p]),
+        "fs_create": (P, [ctypes.c_int, ctypes.c_int, ctypes.c_uint32]),
+        "fs_destroy": (None, [P]),
+        "fs_width": (ctypes.c_int, [P]),
+        "fs_height": (ctypes.c_int, [P]),
+        "fs_ticks": (ctypes.c_uint64, [P]),
+        "fs_step": (None, [P, ctypes.c_int]),
+        "fs_plane": (u8p, [P]),
+        "fs_get_plane": (ctypes.c_int, [P, P, ctypes.c_size_t]),
+        "fs_set_plane": (ctypes.c_int, [P, P, ctypes.c_size_t]),
+        "fs_paint": (None, [P, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int]),
+        "fs_take_dirty_rect": (ctypes.c_int, [P, ip, ip, ip, ip]),
+        "fs_get_stats": (None, [P, ctypes.POINTER(Stats)]),
+        "fs_hash": (ctypes.c_uint64, [P]),
+        "fs_enable_chunk_hashes": (None, [P, ctypes.c_int]),
+        "fs_chunk_hash": (ctypes.c_uint64, [P, ctypes.c_int, ctypes.c_int]),
+    }
+    for name, (res, args) in sig.items():
+        fn = getattr(lib, name)
+        fn.restype = res
+        fn.argtypes = args
+    if lib.fs_api_version() != API_VERSION:
+        raise RuntimeError("libfallingsand: version de API %d, se esperaba %d"
+                           % (lib.fs_api_version(), API_VERSION))
+    return lib
+
+
+_lib = _load()
+
+
+def load_materials(path):
+    """Carga un fichero .mat (antes de crear mundos)."""
+    return bool(_lib.fs_load_materials(os.fsencode(path)))
+
+
+def material_id(name):
+    """id del material por nombre; ValueError si no existe."""
+    mid = _lib.fs_material_id(name.encode())
+    if mid < 0:
+        raise ValueError("material desconocido: %s" % name)
+    return mid
+
+
+def _buffer_address(buf, size, writable):
+    """(direccion, ancla) de un buffer del llamador (bytearray, numpy, ctypes) sin copiarlo.
+
+    'ancla' mantiene vivo el objeto que posee la memoria durante la llamada.
+    """
+    if np is not None and isinstance(buf, np.ndarray):
+        if buf.dtype != np.uint8 or not buf.flags["C_CONTIGUOUS"] or buf.nbytes < size:
+            raise ValueError("se necesita un ndarray uint8 contiguo de %d bytes" % size)
+        if writable and not buf.flags["WRITEABLE"]:
+            raise ValueError("el ndarray no es escribible")
+        return buf.ctypes.data, buf
+    if isinstance(buf, ctypes.Array):
+        if ctypes.sizeof(buf) < size:
+            raise ValueError("buffer de %d bytes, se necesitan %d" % (ctypes.sizeof(buf), size))
+        return ctypes.addressof(buf), buf
+    mv = memoryview(buf)
+    if mv.nbytes < size or not mv.c_contiguous:
+        raise ValueError("se necesita un buffer contiguo de %d bytes" % size)
+    if mv.readonly:
+        if writable:
+            raise ValueError("el buffer es de solo lectura")
+        # bytes y similares no exponen puntero escribible: una copia solo en este caso
+        tmp = (ctypes.c_char * mv.nbytes).from_buffer_copy(mv)
+        return ctypes.addressof(tmp), tmp
+    arr = (ctypes.c_char * mv.nbytes).from_buffer(mv)
+    return ctypes.addressof(arr), arr
+
+
+class World:
+    """Un mundo del motor nativo. No es seguro usar el mismo mundo desde varios hilos."""
+
+    def __init__(self, width, height, seed=0x9E3779B9):
+        self._h = _lib.fs_create(width, height, seed & 0xFFFFFFFF)
+        if not self._h:
+            raise MemoryError("fs_create(%d, %d) fallo" % (width, height))
+        self.width = width
+        self.height = height
+        self.size = width * height
+
+    def close(self):
+        if self._h:
+            _lib.fs_destroy(self._h)
+            self._h = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    @property
+    def ticks(self):
+        return _lib.fs_ticks(self._h)
+
+    @property
+    def hash(self):
+        """Hash Zobrist del plano: dos mundos con el mismo plano dan el mismo hash."""
+        return _lib.fs_hash(self._h)
+
+    def enable_chunk_hashes(self, on=True):
+        _lib.fs_enable_chunk_hashes(self._h, 1 if on else 0)
+
+    def chunk_hash(self, cx, cy):
+        """Sub-hash del chunk (cx, cy) de 32x32 celdas (0 si no estan activados)."""
+        return _lib.fs_chunk_hash(self._h, cx, cy)
+
+    def step(self, ticks=1):
+        _lib.fs_step(self._h, ticks)
+
+    def paint(self, cx, cy, material, radius):
+        _lib.fs_paint(self._h, cx, cy, material, radius)
+
+    def plane_view(self):
+        """Vista de solo lectura del plano del motor, sin copia.
+
+        Valida hasta el siguiente step/paint/set_plane: el motor alterna buffers.
+        """
+        ptr = _lib.fs_plane(self._h)
+        arr = (ctypes.c_uint8 * self.size).from_address(ctypes.addressof(ptr.contents))
+        if np is not None:
+            view = np.ctypeslib.as_array(arr).reshape(self.height, self.width)
+            view.flags.writeable = False
+            return view
+        return memoryview(arr).toreadonly()
+
+    def get_plane(self, out=None):
+        """Copia el plano en 'out' (bytearray/ndarray/ctypes de w*h bytes) o en uno nuevo."""
+        if out is None:
+            out = np.empty((self.height, self.width), np.uint8) if np is not None else bytearray(self.size)
+        addr, _keep = _buffer_address(out, self.size, True)
+        if not _lib.fs_get_plane(self._h, addr, self.size):
+            raise ValueError("fs_get_plane fallo")
+        return out
+
+    def set_plane(self, src):
+        """Sustituye el plano desde un buffer de w*h bytes (ids de material)."""
+        addr, _keep = _buffer_address(src, self.size, False)
+        if not _lib.fs_set_plane(self._h, addr, self.size):
+            raise ValueError("fs_set_plane: se necesitan exactamente %d bytes con ids de material validos" % self.size)
+
+    def take_dirty_rect(self):
+        """(x, y, w, h) de lo cambiado desde la ultima llamada, o None."""
+        x, y, rw, rh = ctypes.c_int(), ctypes.c_int(), ctypes.c_int(), ctypes.c_int()
+        if not _lib.fs_take_dirty_rect(self._h, ctypes.byref(x), ctypes.byref(y),
+                                       ctypes.byref(rw), ctypes.byref(rh)):
+            return None
+        return x.value, y.value, rw.value, rh.value
+
+    def stats(self):
+        """dict con ticks, dirty_cells, quiet_ticks, seconds y counts {id: celdas}."""
+        s = Stats()
+        _lib.fs_get_stats(self._h, ctypes.byref(s))
+        return {
+            "ticks": s.ticks,
+            "dirty_cells": s.dirty_cells,
+            "quiet_ticks": s.quiet_ticks,
+            "seconds": s.seconds,
+            "counts": {m: c for m, c in enumerate(s.counts) if c},
+        }
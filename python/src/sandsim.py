@@ -0,0 +1,221 @@
+"""Simulacion del prototipo (listas activas con sets), sin pygame.
+
+La usa fallingSand.py para la ventana y bench_compare.py para medirla sin
+pantalla. Las reglas son las del prototipo original; el azar sale de un
+random.Random propio para poder repetir una ejecucion con la misma semilla.
+"""
+import random
+
+# TIPOS DE PARTICULAS
+EMPTY = 0
+SAND = 1
+WATER = 2
+WOOD = 3
+FIRE = 4
+SMOKE = 5
+
+NAMES = {EMPTY: "Empty", SAND: "Sand", WATER: "Water", WOOD: "Wood", FIRE: "Fire", SMOKE: "Smoke"}
+
+
+class SandSim:
+    def __init__(self, cols, rows, seed=None):
+        self.cols = cols
+        self.rows = rows
+        self.rng = random.Random(seed)
+        self.grid = [[EMPTY for _ in range(rows)] for _ in range(cols)]
+
+        # PARTICULAS ACTIVAS
+        self.active_sand = set()
+        self.active_water = set()
+        self.active_wood = set()
+        self.active_fire = {}
+        self.active_smoke = set()
+
+    def in_bounds(self, x, y):
+        return 0 <= x < self.cols and 0 <= y < self.rows
+
+    def swap_particles(self, x1, y1, x2, y2):
+        grid = self.grid
+        grid[x1][y1], grid[x2][y2] = grid[x2][y2], grid[x1][y1]
+        for s in [self.active_sand, self.active_water, self.active_smoke, self.active_wood]:
+            if (x1, y1) in s:
+                s.discard((x1, y1)); s.add((x2, y2))
+            elif (x2, y2) in s:
+                s.discard((x2, y2)); s.add((x1, y1))
+        if (x1, y1) in self.active_fire:
+            self.active_fire[(x2, y2)] = self.active_fire.pop((x1, y1))
+        elif (x2, y2) in self.active_fire:
+            self.active_fire[(x1, y1)] = self.active_fire.pop((x2, y2))
+
+    def update(self):
+        grid = self.grid
+        in_bounds = self.in_bounds
+        rng = self.rng
+
+        # --- Arena ---
+        for x, y in list(self.active_sand):
+            if not in_bounds(x, y): continue
+            below = (x, y+1)
+            if in_bounds(*below) and (grid[below[0]][below[1]] in [EMPTY, WATER]):
+                self.swap_particles(x, y, *below)
+            else:
+                dx = rng.choice([-1, 1])
+                diag = (x+dx, y+1)
+                if in_bounds(*diag) and grid[diag[0]][diag[1]] in [EMPTY, WATER]:
+                    self.swap_particles(x, y, *diag)
+
+        # --- Agua ---
+        for x, y in list(self.active_water):
+            if not in_bounds(x, y): continue
+            below = (x, y+1)
+            if in_bounds(*below) and grid[below[0]][below[1]] == EMPTY:
+                self.swap_particles(x, y, *below)
+            else:
+                dx = rng.choice([-1, 1])
+                side = (x+dx, y)
+                if in_bounds(*side) and grid[side[0]][side[1]] == EMPTY:
+                    self.swap_particles(x, y, *side)
+
+        # --- Fuego ---
+        for x, y in list(self.active_fire):
+            if not in_bounds(x, y): continue
+            # Quemar madera adyacente
+            for dx, dy in [(-1, 0), (1, 0), (0, -1), (0, 1), (1, 1), (-1, -1), (-1, 1), (1, -1)]:
+                nx, ny = x+dx, y+dy
+                if in_bounds(nx, ny) and grid[nx][ny] == WOOD:
+                    self.add_particle(nx, ny, FIRE)
+            # Vida util
+            self.active_fire[(x, y)] -= 1
+            if self.active_fire[(x, y)] <= 0 or rng.random() < 0.02:
+                self.remove_particle(x, y)
+                above = (x, y-1)
+                if in_bounds(*above) and grid[above[0]][above[1]] == EMPTY:
+                    self.add_particle(*above, SMOKE)
+
+        # --- Humo ---
+        for x, y in list(self.active_smoke):
+            if not in_bounds(x, y): continue
+            above = (x, y-1)
+            if in_bounds(*above) and grid[above[0]][above[1]] == EMPTY:
+                self.swap_particles(x, y, *above)
+            else:
+                if rng.random() < 0.01:
+                    self.remove_particle(x, y)
+                else:
+                    dx = rng.choice([-1, 1])
+                    side = (x+dx, y)
+                    if in_bounds(*side) and grid[side[0]][side[1]] == EMPTY:
+                        self.swap_particles(x, y, *side)
+
+    def add_particle_area(self, x, y, p_type, size=2):
+        for dx in range(-size, size+1):
+            for dy in range(-size, size+1):
+                if dx*dx + dy*dy <= size*size:
+                    self.add_particle(x+dx, y+dy, p_type)
+
+    def add_particle(self, x, y, p_type):
+        if not self.in_bounds(x, y):
+            return
+
+        self.remove_particle(x, y)
+        self.grid[x][y] = p_type
+        if p_type == SAND:
+            self.active_sand.add((x, y))
+        elif p_type == WATER:
+            self.active_water.add((x, y))
+        elif p_type == FIRE:
+            self.active_fire[(x, y)] = self.rng.randint(30, 100)  # vida util en frames
+        elif p_type == SMOKE:
+            self.active_smoke.add((x, y))
+        elif p_type == WOOD:
+            self.active_wood.add((x, y))
+
+    def remove_particle(self, x, y):
+        p = self.grid[x][y]
+        self.grid[x][y] = EMPTY
+        if p == SAND: self.active_sand.discard((x, y))
+        elif p == WATER: self.active_water.discard((x, y))
+        elif p == FIRE: self.active_fire.pop((x, y), None)
+        elif p == SMOKE: self.active_smoke.discard((x, y))
+        elif p == WOOD: self.active_wood.discard((x, y))
+
+    # ------------------------- escenas -------------------------
+    def rebuild_active(self):
+        self.active_sand.clear(); self.active_water.clear(); self.active_wood.clear()
+        self.active_fire.clear(); self.active_smoke.clear()
+        for x in range(self.cols):
+            for y in range(self.rows):
+                p = self.grid[x][y]
+                if p == SAND: self.active_sand.add((x, y))
+                elif p == WATER: self.active_water.add((x, y))
+                elif p == WOOD: self.active_wood.add((x, y))
+                elif p == FIRE: self.active_fire[(x, y)] = self.rng.randint(30, 100)
+                elif p == SMOKE: self.active_smoke.add((x, y))
+
+    def save_txt(self, path):
+        """Una fila por linea, ids separados por espacios (formato de python/saved)."""
+        with open(path, "w") as f:
+            for y in range(self.rows):
+                f.write(" ".join(str(self.grid[x][y]) for x in range(self.cols)) + "\n")
+
+    def load_txt(self, path):
+        for y, row in enumerate(read_rows(path)):
+            for x, val in enumerate(row):
+                self.grid[x][y] = int(val)
+        self.rebuild_active()
+
+    def plane(self):
+        """bytes fila a fila (y=0 arriba) con los ids del prototipo."""
+        return bytes(self.grid[x][y] for y in range(self.rows) for x in range(self.cols))
+
+
+def iter_rows(path):
+    """Filas de una escena guardada, una a una; las lineas en blanco no cuentan (como
+    loadPythonScene)."""
+    with open(path, "r") as f:
+        for line in f:
+            row = line.split()
+            if row:
+                yield row
+
+
+def read_rows(path):
+    return list(iter_rows(path))
+
+
+def scene_size(path):
+    """(cols, rows) de una escena guardada, sin tenerla entera en memoria."""
+    cols = rows = 0
+    for row in iter_rows(path):
+        cols = max(cols, len(row))
+        rows += 1
+    return cols, rows
+
+
+def _check_roundtrip():
+    """save_txt -> load_txt con lineas en blanco intercaladas devuelve la misma rejilla."""
+    import os
+    import tempfile
+    src = SandSim(7, 5, seed=3)
+    for x in range(src.cols):
+        for y in range(src.rows):
+            src.grid[x][y] = src.rng.choice(list(NAMES))
+    fd, path = tempfile.mkstemp(suffix=".txt")
+    os.close(fd)
+    try:
+        src.save_txt(path)
+        with open(path, "r") as f:
+            lines = f.readlines()
+        with open(path, "w") as f:
+            f.write("\n" + lines[0] + "\n  \n" + "".join(lines[1:]) + "\n")
+        assert scene_size(path) == (src.cols, src.rows), scene_size(path)
+        dst = SandSim(src.cols, src.rows, seed=3)
+        dst.load_txt(path)
+        assert dst.grid == src.grid
+    finally:
+        os.remove(path)
+    print("roundtrip ok")
+
+
+if __name__ == "__main__":
+    _check_roundtrip()